@@ -2,85 +2,12 @@ namespace Dexy { namespace AdcInput {
 
 constexpr unsigned maskAdcInputs = mask_low_bits(Gpio::numAdcInputs);
 
-constexpr unsigned maxAdcValue = 4095;
-
 /// @brief ADC capture buffer
 static adcBuffer_t adcBuffer;
 
 /// @brief Critical section to protect adcBuffer
 using CritSecAdcBuffer = CritSec<adcBuffer_t>;
 
-/// @brief Adjust for ADC non-linearity by fudging the ADC input value
-/// @param adcValue Analog input value
-/// @return Adjusted analog value
-/// @note See RP2040 Datasheet section 4.9.4 and errata E11
-static constexpr int linearizeAdcInput(int adcValue)
-{
-    int adcAdjust = 0;
-    // Calculate the accumulated differential error
-    if (adcValue >= 512) {
-        adcAdjust += 9;
-        if (adcValue >= 1024) {
-            adcAdjust += 1;
-            if (adcValue >= 1536) {
-                adcAdjust += 8;
-                if (adcValue >= 2048) {
-                    adcAdjust += -3;
-                    if (adcValue >= 2560) {
-                        adcAdjust += 8;
-                        if (adcValue >= 3072) {
-                            adcAdjust += 1;
-                            if (adcValue >= 3584) {
-                                adcAdjust += 9;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    // Subtract an overall linear correction
-    adcAdjust -= (adcValue >> 7);
-    return adcValue + adcAdjust;
-}
-
-/// @brief Lookup table to map an ADC input value to a note pitch
-/// @details The pitch is expressed as a wavetable increment value (phase_t).
-static constexpr DataTable<phase_t, maxAdcValue+1,
-    [](std::size_t index, [[maybe_unused]] std::size_t numValues) {
-        // Table is indexed by the ADC input value, representing pitch CV
-        int adcValue = index;
-        // ADC input adjustment
-        adcValue = linearizeAdcInput(adcValue);
-        // ADC input to pitch CV
-        // NOTE: ADC might not read all the way up to 3.3V (I measured 3.275V on mine).
-        // Set CV voltage divider and adcValueMax appropriately.
-        constexpr double adcValueMin = 26; //17;        // ADC reading with 0V input
-        constexpr double adcValueMax = 3626; //4128.4;  // ADC reading with cvMax input
-        constexpr double cvMax = 9.0; // 10.0;          // Max CV used for calibration
-        double cv = (adcValue - adcValueMin) * cvMax / (adcValueMax - adcValueMin);
-        // pitch CV to frequency
-        constexpr double freqHzBase = 16.3516;
-        constexpr double freqHzAdj = 0; // 0.15;
-        double freqHz = (freqHzBase + freqHzAdj) * std::pow(2.0, cv);
-        // frequency to wavetable increment
-        double waveIncrement = SineWave::getIncrementForHz(freqHz);
-        return phase_t(std::round(waveIncrement));
-    }> adcToIncrementMap;
-
-/// @brief Lookup table to map an ADC input value to a timbre modulation value
-static constexpr DataTable<output_t, maxAdcValue+1,
-    [](std::size_t index, [[maybe_unused]] std::size_t numValues) {
-        int adcValue = index;
-        adcValue = linearizeAdcInput(adcValue);
-        constexpr double adcValueMin = 31.5;    // ADC min reading
-        constexpr double adcValueMax = 4007.3;  // ADC max reading
-        double out = (adcValue - adcValueMin) / (adcValueMax - adcValueMin)
-            * (max_output_t - min_output_t) + min_output_t;
-        out = std::min(std::max(out, double(min_output_t)), double(max_output_t));
-        return output_t(out);
-    }> adcToTimbreModMap;
-
 IN_FLASH("AdcInput")
 void init()
 {
@@ -131,16 +58,4 @@ adcResult_t getCurrentValue()
     return adcBuffer[adcInput];
 }
 
-phase_t getIncrementForAdcValue(adcResult_t value)
-{
-    assert(value <= maxAdcValue);
-    return adcToIncrementMap[value];
-}
-
-output_t getTimbreModForAdcValue(adcResult_t value)
-{
-    assert(value <= maxAdcValue);
-    return adcToTimbreModMap[value];
-}
-
 } } // namespace AdcInput
@@ -6,7 +6,7 @@ namespace Dexy {
 namespace AdcInput {
 
 /// @brief Result of reading the ADC
-using adcResult_t = uint16_t;
+using adcResult_t = AdcMap::adcResult_t;
 
 /// @brief Data buffer containing results of reading all the analog inputs
 using adcBuffer_t = adcResult_t[Gpio::numAdcInputs];
@@ -27,16 +27,6 @@ void getCurrentValues(adcBuffer_t* buf);
 template<unsigned adcInput>
 adcResult_t getCurrentValue();
 
-/// @brief Calculate the wavetable increment value for a note pitch corresponding
-/// to a given ADC input value
-/// @param value ADC input value corresponding to a pitch
-/// @return Wavetable increment value for the desired pitch
-phase_t getIncrementForAdcValue(adcResult_t value);
-
-/// @brief Calculate the timbre modulation value for a note pitch corresponding
-/// to a given ADC input value
-/// @param value ADC input value corresponding to the modulation amount
-/// @return Modulation amount
-output_t getTimbreModForAdcValue(adcResult_t value);
+// The mapping of ADC input values to pitch and timbre modulation is in AdcMap.
 
 } } // namespace AdcInput
@@ -0,0 +1,166 @@
+namespace Dexy { namespace AdcMap {
+
+/// @brief Adjust for ADC non-linearity by fudging the ADC input value
+/// @param adcValue Analog input value
+/// @return Adjusted analog value
+/// @note See RP2040 Datasheet section 4.9.4 and errata E11
+static constexpr int linearizeAdcInput(int adcValue)
+{
+    int adcAdjust = 0;
+    // Calculate the accumulated differential error
+    if (adcValue >= 512) {
+        adcAdjust += 9;
+        if (adcValue >= 1024) {
+            adcAdjust += 1;
+            if (adcValue >= 1536) {
+                adcAdjust += 8;
+                if (adcValue >= 2048) {
+                    adcAdjust += -3;
+                    if (adcValue >= 2560) {
+                        adcAdjust += 8;
+                        if (adcValue >= 3072) {
+                            adcAdjust += 1;
+                            if (adcValue >= 3584) {
+                                adcAdjust += 9;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    // Subtract an overall linear correction
+    adcAdjust -= (adcValue >> 7);
+    return adcValue + adcAdjust;
+}
+
+/// @brief Maximum ADC input value after linearizeAdcInput()
+constexpr int maxLinearAdcValue = linearizeAdcInput(maxAdcValue);
+
+/// @brief Calculate the note pitch for a (linearized) ADC input value
+/// @details The pitch is expressed as a wavetable increment value (phase_t).
+static constexpr phase_t calcIncrementForAdcValue(int adcValue)
+{
+    // ADC input to pitch CV
+    // NOTE: ADC might not read all the way up to 3.3V (I measured 3.275V on mine).
+    // Set CV voltage divider and adcValueMax appropriately.
+    constexpr double adcValueMin = 26; //17;        // ADC reading with 0V input
+    constexpr double adcValueMax = 3626; //4128.4;  // ADC reading with cvMax input
+    constexpr double cvMax = 9.0; // 10.0;          // Max CV used for calibration
+    double cv = (adcValue - adcValueMin) * cvMax / (adcValueMax - adcValueMin);
+    // pitch CV to frequency
+    constexpr double freqHzBase = 16.3516;
+    constexpr double freqHzAdj = 0; // 0.15;
+    double freqHz = (freqHzBase + freqHzAdj) * std::pow(2.0, cv);
+    // frequency to wavetable increment
+    double waveIncrement = SineWave::getIncrementForHz(freqHz);
+    return phase_t(std::round(waveIncrement));
+}
+
+constexpr double timbreAdcValueMin = 31.5;      ///< ADC min reading for timbre modulation
+constexpr double timbreAdcValueMax = 4007.3;    ///< ADC max reading for timbre modulation
+
+/// @brief Timbre modulation per (linearized) ADC input value
+constexpr double timbreModPerAdcValue = (max_output_t - min_output_t) / (timbreAdcValueMax - timbreAdcValueMin);
+
+/// @brief Calculate the timbre modulation value for a (linearized) ADC input
+/// value, before clamping to the output_t range
+static constexpr int32_t calcTimbreModForAdcValue(int adcValue)
+{
+    double out = (adcValue - timbreAdcValueMin) * timbreModPerAdcValue + min_output_t;
+    return int32_t(out);
+}
+
+/// @brief Maximum pitch error of the ADC pitch table in cents
+constexpr double maxPitchErrorCents = 0.5;
+
+/// @brief Lookup table to map a linearized ADC input value to a note pitch
+/// @details The pitch is expressed as a wavetable increment value (phase_t).
+/// The ADC non-linearity adjustment has steps, so it is applied before the
+/// table lookup, and the mapping from the linearized value is smooth.
+/// Every 16th entry is stored, within maxPitchErrorCents.
+static constexpr InterpolatedDataTable<phase_t, maxLinearAdcValue+1, 16,
+    [](std::size_t index, [[maybe_unused]] std::size_t numValues) {
+        return calcIncrementForAdcValue(int(index));
+    }, std::pow(2.0, maxPitchErrorCents / 1200) - 1> adcToIncrementMap;
+
+/// @brief Worst-case pitch error of adcToIncrementMap in cents, compared with
+/// calculating every value
+/// @details The table's own check allows another 1 for rounding, which is
+/// about 0.3 cents at the lowest pitches, so the limit is checked here too.
+static consteval double maxIncrementErrorCents()
+{
+    double maxError = 0;
+    for (unsigned value = 0; value <= maxAdcValue; ++value) {
+        double exact = calcIncrementForAdcValue(linearizeAdcInput(int(value)));
+        double approx = adcToIncrementMap[std::size_t(linearizeAdcInput(int(value)))];
+        maxError = std::max(maxError, std::abs(1200 * std::log2(approx / exact)));
+    }
+    return maxError;
+}
+static_assert(maxIncrementErrorCents() < maxPitchErrorCents, "ADC pitch table is not accurate enough");
+
+/// @brief Number of fraction bits in timbreModScale and timbreModOffset
+constexpr unsigned cbitsTimbreMod = 14;
+
+/// @brief timbreModPerAdcValue in fixed point
+constexpr int32_t timbreModScale = int32_t(std::round(timbreModPerAdcValue * (1 << cbitsTimbreMod)));
+
+/// @brief Timbre modulation value for a linearized ADC value of 0 in fixed
+/// point, plus 0.5 for rounding
+constexpr int32_t timbreModOffset = int32_t(std::round(
+    (min_output_t - timbreAdcValueMin * timbreModPerAdcValue + 0.5) * (1 << cbitsTimbreMod)));
+
+static_assert(int64_t(maxLinearAdcValue) * timbreModScale + timbreModOffset <= INT32_MAX
+              && timbreModOffset >= INT32_MIN, "Timbre modulation calculation overflows");
+
+/// @brief Calculate the timbre modulation value for a linearized ADC input
+/// value with 32-bit fixed-point maths
+/// @details The mapping is linear, so it doesn't need a table.
+static constexpr output_t calcTimbreModFixedPoint(int adcValue)
+{
+    int32_t out = (adcValue * timbreModScale + timbreModOffset) >> cbitsTimbreMod;
+    return output_t(std::clamp(out, int32_t(min_output_t), int32_t(max_output_t)));
+}
+
+/// @brief Worst-case error of calcTimbreModFixedPoint(), compared with
+/// calculating every value in double precision
+static consteval int32_t maxTimbreModError()
+{
+    int32_t maxError = 0;
+    for (unsigned value = 0; value <= maxAdcValue; ++value) {
+        int32_t exact = std::clamp(calcTimbreModForAdcValue(linearizeAdcInput(int(value))),
+                                   int32_t(min_output_t), int32_t(max_output_t));
+        int32_t approx = calcTimbreModFixedPoint(linearizeAdcInput(int(value)));
+        maxError = std::max(maxError, (approx > exact) ? approx - exact : exact - approx);
+    }
+    return maxError;
+}
+static_assert(maxTimbreModError() <= 1, "ADC timbre modulation calculation is not accurate enough");
+
+phase_t getIncrementForAdcValue(adcResult_t value)
+{
+    assert(value <= maxAdcValue);
+    return adcToIncrementMap[linearizeAdcInput(value)];
+}
+
+output_t getTimbreModForAdcValue(adcResult_t value)
+{
+    assert(value <= maxAdcValue);
+    return calcTimbreModFixedPoint(linearizeAdcInput(value));
+}
+
+phase_t getExactIncrementForAdcValue(adcResult_t value)
+{
+    assert(value <= maxAdcValue);
+    return calcIncrementForAdcValue(linearizeAdcInput(value));
+}
+
+output_t getExactTimbreModForAdcValue(adcResult_t value)
+{
+    assert(value <= maxAdcValue);
+    int32_t out = calcTimbreModForAdcValue(linearizeAdcInput(value));
+    return output_t(std::clamp(out, int32_t(min_output_t), int32_t(max_output_t)));
+}
+
+} } // namespace AdcMap
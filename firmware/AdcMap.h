@@ -0,0 +1,43 @@
+#pragma once
+
+namespace Dexy {
+
+/// @brief Mapping of ADC input values to the synth's pitch and timbre
+/// modulation
+/// @details This has no hardware dependencies, so the host build can test it.
+/// @see AdcInput
+namespace AdcMap {
+
+/// @brief Result of reading the ADC
+using adcResult_t = uint16_t;
+
+/// @brief Maximum ADC reading
+constexpr unsigned maxAdcValue = 4095;
+
+/// @brief Calculate the wavetable increment value for a note pitch corresponding
+/// to a given ADC input value
+/// @param value ADC input value corresponding to a pitch
+/// @return Wavetable increment value for the desired pitch
+phase_t getIncrementForAdcValue(adcResult_t value);
+
+/// @brief Calculate the timbre modulation value corresponding to a given ADC
+/// input value
+/// @param value ADC input value corresponding to the modulation amount
+/// @return Modulation amount
+output_t getTimbreModForAdcValue(adcResult_t value);
+
+/// @brief Calculate the wavetable increment value for an ADC input value in
+/// double precision, without the lookup table
+/// @details For testing getIncrementForAdcValue() - too slow for real time.
+/// @param value ADC input value corresponding to a pitch
+/// @return Wavetable increment value, rounded
+phase_t getExactIncrementForAdcValue(adcResult_t value);
+
+/// @brief Calculate the timbre modulation value for an ADC input value in
+/// double precision
+/// @details For testing getTimbreModForAdcValue() - too slow for real time.
+/// @param value ADC input value corresponding to the modulation amount
+/// @return Modulation amount
+output_t getExactTimbreModForAdcValue(adcResult_t value);
+
+} } // namespace AdcMap
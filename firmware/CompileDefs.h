@@ -16,6 +16,44 @@
 /// IN_FLASH due to linker behaviour.)
 #define IN_FLASH(group) __in_flash(group)
 
+/// @brief Send output to the DAC using PIO & DMA instead of SPI in the timer
+/// interrupt handler
+/// @details The DMA is paced by the sample timer and sends pre-formatted
+/// command words from SpiDac's output buffer to a PIO program (DacSpi.pio)
+/// that drives SCK, MOSI, CS and LDAC. This takes the SPI transfer out of
+/// core 1's timer interrupt.
+#undef DAC_OUTPUT_DMA
+
+/// @brief Evaluate envelopes at control rate instead of every sample
+/// @details Define this as the number of samples between envelope evaluations,
+/// e.g. @code #define ENVELOPE_CONTROL_RATE 16 @endcode
+/// The envelope level is ramped linearly in between. Stage transitions
+/// still happen on exactly the same sample as without this.
+/// @see Envelope::genNextOutputRamped()
+#undef ENVELOPE_CONTROL_RATE
+
+/// @brief Use core 1's hardware interpolators for sine wavetable lookups
+/// @details Linear interpolation with an 8-bit fraction instead of
+/// Interpolate::Average3. Not bit-exact with the default build.
+/// @see Interpolate::Hardware
+#undef WAVETABLE_HW_INTERP
+
+/// @brief Store only a quarter of the sine wave, with 4 times the resolution
+/// in the same memory
+/// @details Not bit-exact with the default build. The hardware interpolators
+/// aren't used for this table: with WAVETABLE_HW_INTERP it gets the equivalent
+/// software interpolation, Interpolate::Blend8.
+/// @see QuarterWaveTable
+#undef SINE_QUARTER_WAVE
+
+/// @brief Combine each operator's amplitude modulation and output level into
+/// one gain, so that scaling its output takes one multiply per sample instead
+/// of three
+/// @details Not bit-exact with the default build: the levels are rounded once
+/// instead of three times (see GainStagingBench).
+/// @see Operator::calcGain()
+#undef OPERATOR_FOLDED_GAIN
+
 #if !(defined(COPY_TO_RAM) && COPY_TO_RAM)
     #error "Must be compiled with pico_set_binary_type(Dexy copy_to_ram)"
 #else
@@ -26,6 +26,7 @@ static constexpr Tasks::TaskList<
     //TestTasks::PitchCvHisto,
     //TestTasks::PitchCvAverage,
     //TestTasks::MonitorTemp,
+    //TestTasks::OutputBufferLevel,
     SerialIO::SerialIOTask,
     UI::UITask,
     Watchdog // should be last
@@ -69,12 +70,9 @@ void onTimerInterrupt()
     AdcInput::readAll();
     static AdcInput::adcBuffer_t adcBuf;
     AdcInput::getCurrentValues(&adcBuf);
-    AdcInput::adcResult_t adcPitch = adcBuf[Gpio::adcInputPitch];
-    // Average adcPitch with the previous value to provide some extra filtering
-    static AdcInput::adcResult_t adcPitchPrev = 0;
-    adcPitchPrev = getAndSet(adcPitch, AdcInput::adcResult_t((adcPitch + adcPitchPrev) / 2));
-    Synth::setNotePitch(AdcInput::getIncrementForAdcValue(adcPitch));
-    Synth::setTimbreMod(AdcInput::getTimbreModForAdcValue(adcBuf[Gpio::adcInputTimbre]));
+    static PitchCv<AdcInput::adcResult_t, pitchCvHysteresis> pitchCv;
+    pitchCv.update(adcBuf[Gpio::adcInputPitch], AdcMap::getIncrementForAdcValue);
+    Synth::setTimbreMod(AdcMap::getTimbreModForAdcValue(adcBuf[Gpio::adcInputTimbre]));
 }
 
 } } // namespace Core0
@@ -3,6 +3,13 @@ namespace Dexy { namespace Core1 {
 [[noreturn]]
 static void synthLoop();
 
+/// @brief Number of audio samples generated at a time by synthLoop()
+constexpr unsigned synthBlockSize = 8;
+static_assert(synthBlockSize < SpiDac::outputBufferSize,
+    "The output buffer must have room for more than one block");
+static_assert(synthBlockSize <= SpiDac::outputBufferSize / 2,
+    "A block must fit in half of the output buffer (see DAC_OUTPUT_DMA and SpiDac::init())");
+
 constexpr unsigned gateInterruptFlags = (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
 
 [[noreturn]] IN_FLASH("Core1")
@@ -35,14 +42,16 @@ void main()
 static void synthLoop()
 {
     for (;;) {
-        // Generate the next output value
-        SpiDac::dacdata_t output =
-            SpiDac::dacdata_t(int32_t(Synth::genNextOutput()) + SpiDac::dacdataZero);
+        // Generate the next block of output values
+        output_t outputs[synthBlockSize];
+        Synth::genNextBlock(outputs);
 
-        // Wait until the previous output sample has been consumed, then set
-        // the new one to be output next. (see SpiDac::onOutputTimer)
-        SpiDac::waitForOutputSent();
-        SpiDac::setOutput(output);
+        // Queue the values to be output (see SpiDac::onOutputTimer). This
+        // waits while the output buffer is full, so synthLoop runs ahead of
+        // the output by up to SpiDac::outputBufferSize samples.
+        for (auto&& output : outputs) {
+            SpiDac::setOutput(SpiDac::dacdata_t(int32_t(output) + SpiDac::dacdataZero));
+        }
     }
 }
 
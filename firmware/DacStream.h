@@ -0,0 +1,122 @@
+// DacStream - Buffer of DAC command words to be streamed to the DAC by DMA
+
+#pragma once
+
+namespace Dexy {
+
+/// @brief Command word format for the MCP4821/4822 DAC
+namespace Mcp482x {
+
+constexpr unsigned bitDacAB = 15;        ///< bit to select DAC unit A or B
+constexpr unsigned bitDacGain = 13;      ///< bit to select gain: 0 = 2x, 1 = 1x
+constexpr unsigned bitDacShutdown = 12;  ///< shutdown bit - active low
+constexpr unsigned dacUnitA = 0;         ///< DAC unit A = 0
+constexpr unsigned dacUnitB = 1;         ///< DAC unit B = 1
+
+/// @brief DAC command word - invariant part
+/// @details Always has gain = 1x and shutdown = nope.
+/// Gain must be set to 1x because the chip supply voltage (3.3V) is too low for 2x gain.
+constexpr uint16_t wDacCmdBase = uint16_t(bitmask(bitDacGain, bitDacShutdown));
+
+/// @brief Make up the SPI command word to output a value
+/// @param value The value to output - only the top 12 bits are used.
+/// @param dacUnit Which of two DAC units to use
+/// @return 16-bit command word
+constexpr uint16_t makeCommand(uint16_t value, unsigned dacUnit)
+{
+    return uint16_t(wDacCmdBase | (dacUnit << bitDacAB) | (value >> 4));
+}
+
+} // namespace Mcp482x
+
+/// @brief Double-buffered stream of pre-formatted DAC command words, to be
+/// sent to the DAC by DMA at the sample rate
+/// @tparam SIZE Total number of command words, in two halves
+///
+/// The DMA hardware sends the two halves alternately, forever. While one half
+/// is being sent the producer fills the other half. When DMA has finished
+/// sending a half it calls onHalfSent(), which is where a late producer is
+/// detected - DMA doesn't wait, so it would re-send stale data.
+///
+/// This class has no hardware dependencies so that it can be tested on the
+/// host along with a model of the DMA.
+///
+/// Notes
+/// -----
+/// As with RingBuffer, each variable is written by only one side, so plain
+/// atomic loads and stores are enough, even on the Cortex M0+.
+template<unsigned SIZE>
+class DacStream
+{
+public:
+    static_assert(SIZE >= 2 && SIZE % 2 == 0, "DacStream SIZE must be even");
+
+    /// @brief Number of command words in each half of the buffer
+    static constexpr unsigned halfSize = SIZE / 2;
+
+    /// @brief Ctor fills the buffer with a silent output value
+    /// @details Both halves are marked as ready so the stream starts cleanly:
+    /// DMA sends half 0 then half 1 while the producer waits to fill half 0.
+    /// @param valueSilent DAC value that represents silence
+    constexpr explicit DacStream(uint16_t valueSilent)
+    {
+        words.fill(Mcp482x::makeCommand(valueSilent, Mcp482x::dacUnitA));
+    }
+
+    /// @brief Add an output value to the stream (producer only)
+    /// @param value DAC output value
+    /// @return true if the value was added, false if there is no space yet
+    bool write(uint16_t value)
+    {
+        unsigned iHalf = iWrite / halfSize;
+        if (iHalf == iHalfSending.load(std::memory_order_acquire)
+            || halfReady[iHalf].load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        words[iWrite] = Mcp482x::makeCommand(value, Mcp482x::dacUnitA);
+        if (++iWrite % halfSize == 0) {
+            // This half is complete and may be sent
+            halfReady[iHalf].store(true, std::memory_order_release);
+            iWrite %= SIZE;
+        }
+        return true;
+    }
+
+    /// @brief Notification that DMA has finished sending one half of the
+    /// buffer and has started on the other half (consumer only)
+    /// @param iHalf The half that has been sent
+    /// @return true if the other half was ready, false if the producer was late
+    bool onHalfSent(unsigned iHalf)
+    {
+        unsigned iHalfNext = 1 - iHalf;
+        iHalfSending.store(iHalfNext, std::memory_order_release);
+        halfReady[iHalf].store(false, std::memory_order_release);
+        bool fReady = halfReady[iHalfNext].load(std::memory_order_acquire);
+        if (!fReady) {
+            lowWaterMark.store(0, std::memory_order_relaxed);
+        }
+        return fReady;
+    }
+
+    /// @brief Address of one half of the buffer, for the DMA
+    /// @param iHalf 0 or 1
+    const uint16_t* getHalf(unsigned iHalf) const { return &words[iHalf * halfSize]; }
+
+    /// @brief Get the low-water mark
+    /// @return halfSize if the producer has kept up since the last reset, or
+    /// 0 if DMA found a half that wasn't ready
+    unsigned getLowWaterMark() const { return lowWaterMark.load(std::memory_order_relaxed); }
+
+    /// @brief Reset the low-water mark
+    void resetLowWaterMark() { lowWaterMark.store(halfSize, std::memory_order_relaxed); }
+
+private:
+    alignas(4) std::array<uint16_t, SIZE> words;    ///< Command words sent by DMA
+    unsigned iWrite = 0;                            ///< Next word to write (producer)
+    std::atomic<unsigned> iHalfSending = 0;         ///< Half being sent by DMA (consumer)
+    std::atomic<bool> halfReady[2] = {true, true};  ///< Half is filled and not yet sent
+    std::atomic<unsigned> lowWaterMark = halfSize;  ///< See getLowWaterMark()
+};
+
+}
@@ -57,4 +57,124 @@ private:
     VALUE_T dataArray[NUM_VALUES];
 };
 
+/// @brief Class template for static tables of pre-calculated data that store
+/// only every STRIDE-th entry and interpolate the rest
+/// @tparam VALUE_T Type of table entries - an integer type
+/// @tparam NUM_VALUES Number of table entries (including the ones not stored)
+/// @tparam STRIDE Distance between stored entries - must be a power of 2
+/// @tparam FUNC_CALC1 Function or lambda to calculate a single table entry,
+/// the same as for DataTable
+/// @tparam TOLERANCE Maximum deviation of an interpolated entry from the value
+/// calculated by FUNC_CALC1, as a fraction of that value. A further deviation
+/// of 1 is allowed for rounding.
+///
+/// This is for smooth functions that would take a lot of memory as a DataTable.
+/// The entries at multiples of STRIDE are calculated at compile time, the
+/// same as DataTable, and the entries in between are linearly interpolated
+/// (with rounding) when they are accessed. The entries after the last multiple
+/// of STRIDE are stored as-is, so the last entry can be a special value.
+///
+/// Every entry is checked against FUNC_CALC1 at compile time, and compilation
+/// fails if one is outside TOLERANCE.
+template<typename VALUE_T, std::size_t NUM_VALUES, std::size_t STRIDE,
+         VALUE_T FUNC_CALC1(std::size_t index, std::size_t numValues), double TOLERANCE>
+class InterpolatedDataTable
+{
+public:
+    static_assert(std::is_integral_v<VALUE_T>, "InterpolatedDataTable VALUE_T must be an integer type");
+    static_assert(STRIDE >= 2 && (STRIDE & (STRIDE - 1)) == 0, "InterpolatedDataTable STRIDE must be a power of 2");
+
+    /// @brief Ctor initializes the stored entries using FUNC_CALC1, at compile time
+    consteval InterpolatedDataTable()
+    {
+        static_assert(calcMaxDeviation() <= 1, "InterpolatedDataTable is not accurate enough for TOLERANCE");
+        for (std::size_t i = 0; i < numStrides + 1; ++i) {
+            strideValues[i] = FUNC_CALC1(i * STRIDE, NUM_VALUES);
+        }
+        for (std::size_t i = 0; i < numTail; ++i) {
+            tailValues[i] = FUNC_CALC1(numStrides * STRIDE + 1 + i, NUM_VALUES);
+        }
+    }
+
+    /// @brief Size of the table, including the entries that aren't stored
+    /// @return Size of the table
+    constexpr std::size_t size() const { return NUM_VALUES; }
+
+    /// @brief Get a table entry
+    /// @param index 
+    /// @return Value at index
+    constexpr VALUE_T operator[](std::size_t index) const
+    {
+        std::size_t iStride = index / STRIDE;
+        if (iStride >= numStrides) {
+            return (index == numStrides * STRIDE) ? strideValues[numStrides]
+                                                  : tailValues[index - numStrides * STRIDE - 1];
+        }
+        return interpolate(strideValues[iStride], strideValues[iStride + 1], index % STRIDE);
+    }
+
+private:
+    /// @brief Number of whole strides: the stored entries are at 0 to
+    /// numStrides * STRIDE
+    static constexpr std::size_t numStrides = (NUM_VALUES - 1) / STRIDE;
+
+    /// @brief Number of entries stored after the last multiple of STRIDE
+    static constexpr std::size_t numTail = NUM_VALUES - 1 - numStrides * STRIDE;
+
+    /// @brief STRIDE as a number of bits
+    static constexpr unsigned cbitsStride = bits_in_num(STRIDE) - 1;
+
+    /// @brief Largest difference between two adjacent stored entries
+    static constexpr uint64_t maxStep = [] {
+        uint64_t maxStepT = 0;
+        for (std::size_t iStride = 0; iStride < numStrides; ++iStride) {
+            int64_t value0 = int64_t(FUNC_CALC1(iStride * STRIDE, NUM_VALUES));
+            int64_t value1 = int64_t(FUNC_CALC1((iStride + 1) * STRIDE, NUM_VALUES));
+            maxStepT = std::max(maxStepT, uint64_t((value1 > value0) ? value1 - value0 : value0 - value1));
+        }
+        return maxStepT;
+    }();
+
+    /// @brief Type used for interpolation, large enough for the difference
+    /// between two stored entries times STRIDE
+    /// @details This is 32 bits whenever the table's values allow it, because
+    /// the Cortex M0+ has no 64-bit multiply instruction.
+    using calc_t = std::conditional_t<(maxStep * STRIDE + STRIDE / 2 <= uint64_t(INT32_MAX)), int32_t, int64_t>;
+
+    /// @brief Interpolate between two stored entries, with rounding
+    /// @details The step from value0 to value1 is interpolated and added to
+    /// value0. That gives the same result as weighting value0 and value1, but
+    /// the products are smaller.
+    static constexpr VALUE_T interpolate(VALUE_T value0, VALUE_T value1, std::size_t offset)
+    {
+        // Subtracting as unsigned gives the right step for unsigned VALUE_T too
+        using ucalc_t = std::make_unsigned_t<calc_t>;
+        calc_t step = calc_t(ucalc_t(value1) - ucalc_t(value0));
+        return VALUE_T(value0 + VALUE_T((step * calc_t(offset) + calc_t(STRIDE / 2)) >> cbitsStride));
+    }
+
+    /// @brief Maximum deviation of an interpolated entry from FUNC_CALC1, in
+    /// units of the allowed deviation (so <= 1 is OK)
+    static consteval double calcMaxDeviation()
+    {
+        double maxDeviation = 0;
+        for (std::size_t iStride = 0; iStride < numStrides; ++iStride) {
+            VALUE_T value0 = FUNC_CALC1(iStride * STRIDE, NUM_VALUES);
+            VALUE_T value1 = FUNC_CALC1((iStride + 1) * STRIDE, NUM_VALUES);
+            for (std::size_t offset = 1; offset < STRIDE; ++offset) {
+                double exact = FUNC_CALC1(iStride * STRIDE + offset, NUM_VALUES);
+                double deviation = std::abs(interpolate(value0, value1, offset) - exact);
+                maxDeviation = std::max(maxDeviation, deviation / (1 + TOLERANCE * std::abs(exact)));
+            }
+        }
+        return maxDeviation;
+    }
+
+    /// @brief Entries at multiples of STRIDE, calculated at compile time
+    VALUE_T strideValues[numStrides + 1];
+
+    /// @brief Entries after the last multiple of STRIDE, calculated at compile time
+    VALUE_T tailValues[numTail > 0 ? numTail : 1];
+};
+
 }
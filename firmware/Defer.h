@@ -6,9 +6,9 @@ namespace Dexy {
 ///
 /// This is a simple way to implement asynchronous function calls that are
 /// executed by a different core or by Dexy::Tasks::Task. It only supports
-/// simple functions with no return value. A mutex may be used to ensure
-/// synchronization between cores. (The mutex is optional because it's only
-/// needed when calling between cores, not between tasks.)
+/// simple functions with no return value. A mutex or a lock-free protocol may
+/// be used to ensure synchronization between cores. (This is optional because
+/// it's only needed when calling between cores, not between tasks.)
 ///
 /// Usage
 /// -----
@@ -21,6 +21,11 @@ namespace Dexy {
 /// @code
 ///     void myFunction(Defer::UseCritSec, unsigned arg) { ... }
 /// @endcode
+/// For cross-core calls without a mutex, declare the function with a dummy
+/// LockFree argument instead:
+/// @code
+///     void myFunction(Defer::LockFree, unsigned arg) { ... }
+/// @endcode
 /// The core or Task that implements the function must periodically call
 /// checkRun() to execute pending function calls:
 /// @code
@@ -38,6 +43,17 @@ namespace Dexy {
 /// functions. It might make sense to use a separate mutex for every function but
 /// that would be a huge pain. The single mutex is not currently a bottleneck so
 /// let's keep it simple.
+///
+/// The LockFree variant is for functions that are polled often, e.g. on every
+/// sample, or called from an interrupt handler. It uses a sequence counter
+/// (seqlock) per function instead of a mutex, so checkRun() is a single load
+/// when nothing is pending, and neither side disables interrupts or spins.
+/// It needs only atomic loads and stores, not read-modify-write operations,
+/// which the Cortex M0+ doesn't have. Restrictions: call() must only be called
+/// from one core (or Task), and checkRun() and clearPending() only from the
+/// core that executes the function. If call() is called again before the
+/// function runs, only the latest argument is used (the same as the other
+/// variants).
 namespace Defer {
 
 /// @brief Initialization - must be called at startup
@@ -101,12 +117,42 @@ bool checkRun();
 template<FuncTypeMutex func>
 void clearPending();
 
+// Deferred calls, lock-free
+
+struct LockFree { };
+
+using FuncTypeLockFree = void (*)(LockFree, unsigned);
+
+/// @brief Make a deferred call to a function (lock-free overload)
+/// @tparam func 
+/// @param arg 
+template<FuncTypeLockFree func>
+void call(unsigned arg);
+
+/// @brief Make a deferred call to a function (lock-free overload)
+/// @tparam func 
+/// @details This overload may be used for a function that ignores its argument.
+template<FuncTypeLockFree func>
+void call();
+
+/// @brief Check if there is a function call pending and if so execute the function
+/// (lock-free overload)
+/// @tparam func 
+/// @return true if the function was executed, false if not
+template<FuncTypeLockFree func>
+bool checkRun();
+
+/// @brief Cancel the pending deferred call to a function (lock-free overload)
+/// @tparam func 
+template<FuncTypeLockFree func>
+void clearPending();
+
 // Implementation
 
 /// @brief Mutex (actually CritSec) to synchronize caller and implemeter
 using CritSecDefer = CritSec<UseCritSec>;
 
-void init()
+inline void init()
 {
     CritSecDefer::init();
 }
@@ -192,4 +238,69 @@ void clearPending()
     pending<FuncTypeMutex, func> = false;
 }
 
+/// @brief Call sequence number for a particular function (LockFree only)
+/// @details Written only by call(). It is odd while call() is storing the
+/// argument, and advances by 2 for each call.
+/// @tparam func 
+template<FuncTypeLockFree func>
+static std::atomic<unsigned> seqCall = 0;
+
+/// @brief Sequence number of the last call that was run or cleared (LockFree only)
+/// @details Only used by the core that runs the function.
+/// @tparam func 
+template<FuncTypeLockFree func>
+static unsigned seqRun = 0;
+
+/// @brief Argument for a pending call to a particular function (LockFree only)
+/// @tparam func 
+template<FuncTypeLockFree func>
+static std::atomic<unsigned> funcArgLockFree = invalidArg;
+
+template<FuncTypeLockFree func>
+void call(unsigned arg)
+{
+    unsigned seq = seqCall<func>.load(std::memory_order_relaxed);
+    // Mark the argument as being written, then write it, then publish it
+    seqCall<func>.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    funcArgLockFree<func>.store(arg, std::memory_order_relaxed);
+    seqCall<func>.store(seq + 2, std::memory_order_release);
+}
+
+template<FuncTypeLockFree func>
+void call()
+{
+    call<func>(invalidArg);
+}
+
+template<FuncTypeLockFree func>
+bool checkRun()
+{
+    unsigned seq = seqCall<func>.load(std::memory_order_acquire);
+    if (seq == seqRun<func>) {
+        return false;
+    }
+    if (seq & 1) {
+        // call() is in progress on the other core - try again next time
+        return false;
+    }
+    unsigned arg = funcArgLockFree<func>.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seqCall<func>.load(std::memory_order_relaxed) != seq) {
+        // call() was called again while reading arg - try again next time
+        return false;
+    }
+    seqRun<func> = seq;
+    func(LockFree(), arg);
+    return true;
+}
+
+template<FuncTypeLockFree func>
+void clearPending()
+{
+    unsigned seq = seqCall<func>.load(std::memory_order_acquire);
+    // If a call is in progress, it is cleared too
+    seqRun<func> = (seq + 1) & ~1u;
+}
+
 } } // namespace Defer
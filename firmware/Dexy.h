@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <climits>
 #include <cmath>
 #include <map>
@@ -13,6 +14,7 @@
 #include <string> // only for ShowDecl.h
 #include <string_view>
 #include <ranges>
+#include <span>
 #include <utility>
 #include <variant>
 #include <stdio.h>
@@ -49,16 +51,21 @@ using namespace std::literals;
 
 #include "CritSec.h"
 #include "Defer.h"
+#include "RingBuffer.h"
+#include "DacStream.h"
 #include "Gpio.h"
 #include "DataTable.h"
 #include "WaveTable.h"
 #include "SineWave.h"
+#include "AdcMap.h"
 #include "AdcInput.h"
 #include "Envelope.h"
 #include "Operator.h"
 #include "SpiDac.h"
 #include "SynthAlgos.h"
+#include "Voice.h"
 #include "Synth.h"
+#include "PitchCv.h"
 #include "Tasks.h"
 #include "TestTasks.h"
 #include "Watchdog.h"
@@ -8,7 +8,9 @@ static constexpr Envelope::progress_t max_progress_t =
     (Envelope::progress_t(1) << cbitsProgress) - 1;
 
 /// @brief Lookup table for exponential mapping of rate parameters
-static constexpr DataTable<Envelope::rate_t, max_param_t+1,
+/// @details Every 8th entry is stored, within 0.1%. The special value for
+/// max_param_t is in the part of the table that is stored in full.
+static constexpr InterpolatedDataTable<Envelope::rate_t, max_param_t+1, 8,
     [](std::size_t index, [[maybe_unused]] std::size_t numValues) {
         // This function must map index 0 -> value 1
         // and max_param_t-1 should give an attack/release time of about 1 ms.
@@ -20,7 +22,7 @@ static constexpr DataTable<Envelope::rate_t, max_param_t+1,
             value = std::round(std::exp(index * 0.01) * 12.0243) - 11;
         }
         return Envelope::rate_t(value);
-    }> expRateMap;
+    }, 0.001> expRateMap;
 
 /// @brief Convert an envelope rate setting (param_t) to a rate_t
 static constexpr Envelope::rate_t rateFromParam(param_t param)
@@ -54,7 +56,8 @@ static constexpr Envelope::rate_t decayRateFromParam(param_t param)
 using AttackTable = WaveTable<level_t, sizeLookupTable,
     [](std::size_t index, [[maybe_unused]] std::size_t numValues) {
         return level_t(std::round(index * index * 0.2499962));
-    }>;
+    },
+    Interpolate::Average3>;
 
 /// @brief Lookup table for reverse mapping level -> progress, used when starting
 /// the attack stage.
@@ -83,7 +86,8 @@ using DecayTable = WaveTable<level_t, sizeLookupTable,
             value = std::round(std::exp((numValues - 1 - index) * 0.01) * 393.996) - 394;
         }
         return level_t(value);
-    }>;
+    },
+    Interpolate::Average3>;
 
 /// @brief Lookup table for reverse mapping level -> progress, used when starting
 /// the decay and release stages.
@@ -104,16 +108,35 @@ void Envelope::init()
 }
 
 void Envelope::setParams(const Patches::EnvParams& params)
+{
+    setSettings(makeSettings(params));
+}
+
+Envelope::Settings Envelope::makeSettings(const Patches::EnvParams& params)
 {
     // Convert input parameters from param_t to appropriate implementation values.
     // TODO: Keyboard (pitch) rate scaling - single number per op; see Complete DX7
-    // params.delay represents a time but delay is a rate, so change it around
-    delay = rateFromParam(max_param_t - params.delay);
-    attack = attackRateFromParam(params.attack);
-    decay = decayRateFromParam(params.decay);
-    sustain = Operator::levelFromParam(params.sustain);
-    release = decayRateFromParam(params.release);
-    loop = params.loop;
+    return Settings{
+        // params.delay represents a time but delay is a rate, so change it around
+        .delay = rateFromParam(max_param_t - params.delay),
+        .attack = attackRateFromParam(params.attack),
+        .decay = decayRateFromParam(params.decay),
+        .sustain = Operator::levelFromParam(params.sustain),
+        .release = decayRateFromParam(params.release),
+        .loop = params.loop
+    };
+}
+
+void Envelope::setSettings(const Settings& settings)
+{
+    delay = settings.delay;
+    attack = settings.attack;
+    decay = settings.decay;
+    sustain = settings.sustain;
+    release = settings.release;
+    loop = settings.loop;
+    // A new sustain level can change where the Decay stage ends
+    segmentLeft = 0;
 }
 
 void Envelope::gateStart()
@@ -121,16 +144,18 @@ void Envelope::gateStart()
     gateOn = true;
     // Start the envelope
     setStage<Stage::Delay>();
+    rampRestart = true;
 }
 
 void Envelope::gateStop()
 {
     if (getAndSet(gateOn, false)) {
         setStage<Stage::Release>();
+        rampRestart = true;
     }
 }
 
-level_t Envelope::genNextOutput()
+level_t Envelope::genNextOutputExact()
 {
     // Note: Each doStageFunction() is responsible for incrementing progress.
     // That's because lookupInterpolate() takes care of it.
@@ -141,13 +166,184 @@ level_t Envelope::genNextOutput()
 void Envelope::stopEnvelope()
 {
     setStage<Stage::Idle>();
+    rampRestart = true;
+}
+
+template<>
+void Envelope::doStage<Envelope::Stage::Idle>();
+
+bool Envelope::isIdle() const
+{
+    return stage == Stage::Idle;
+}
+
+level_t Envelope::getLevel() const
+{
+    return level;
+}
+
+/// @brief Start of the last interval of the envelope lookup tables
+/// @details The decay curve only reaches 0 in the last interval, so segments
+/// end there and the envelope is evaluated with all the checks to catch the
+/// exact sample where the level gets to 0 or the sustain level.
+static constexpr Envelope::progress_t progressTableTail =
+    Envelope::progress_t(sizeLookupTable - 2) << cbitsLookupFraction;
+
+/// @brief Number of steps from start, adding increment each time, that are below limit
+/// @param start Starting position
+/// @param increment Amount to add at each step
+/// @param limit Limit position
+/// @param maxSteps Maximum result
+/// @return Number of positions start + i * increment < limit, for i < maxSteps
+static unsigned stepsBelow(Envelope::progress_t start, Envelope::rate_t increment,
+                           Envelope::progress_t limit, unsigned maxSteps)
+{
+    if (start >= limit)
+        return 0;
+    if (increment == 0)
+        return maxSteps;
+    return std::min((limit - 1 - start) / increment + 1, maxSteps);
+}
+
+unsigned Envelope::getSegmentLength() const
+{
+    // Each doStage() call first checks whether the stage is finished and, if
+    // not, advances progress and calculates the level. The check on the first
+    // sample sees the current values and the check on sample i sees the values
+    // calculated on sample i-1, which are below progressTableTail and so
+    // can't be 0 or at the sustain level.
+    constexpr unsigned maxSteps = segmentUnlimited - 1;
+    switch (stage) {
+    case Stage::Delay:
+        if (level == 0) {
+            return stepsBelow(delayProgress, increment, max_progress_t, maxSteps);
+        } else {
+            return std::min(stepsBelow(delayProgress, increment, max_progress_t, maxSteps),
+                            stepsBelow(progress, increment, progressTableTail, maxSteps) + 1);
+        }
+    case Stage::Attack:
+        return stepsBelow(progress, increment, max_progress_t, maxSteps);
+    case Stage::Decay:
+        if (level <= sustain)
+            return 0;
+        return std::min(stepsBelow(progress, increment, max_progress_t, maxSteps),
+                        stepsBelow(progress, increment, progressTableTail, maxSteps) + 1);
+    case Stage::Release:
+        if (level == 0)
+            return 0;
+        return std::min(stepsBelow(progress, increment, max_progress_t, maxSteps),
+                        stepsBelow(progress, increment, progressTableTail, maxSteps) + 1);
+    default:
+        // Sustain and Idle don't change by themselves
+        return segmentUnlimited;
+    }
+}
+
+void Envelope::renderSegment(std::span<level_t> levels)
+{
+    switch (stage) {
+    case Stage::Delay:
+        if (level == 0) {
+            delayProgress += rate_t(levels.size()) * increment;
+        } else {
+            for (auto&& value : levels) {
+                delayProgress += increment;
+                value = level = DecayTable::lookupInterpolate(&progress, increment);
+            }
+            return;
+        }
+        break;
+    case Stage::Attack:
+        for (auto&& value : levels) {
+            value = level = AttackTable::lookupInterpolate(&progress, increment);
+        }
+        return;
+    case Stage::Decay:
+        for (auto&& value : levels) {
+            level_t levelDecay = DecayTable::lookupInterpolate(&progress, increment);
+            value = level = (max_level_t - levelDecay >= sustain) ? level_t(levelDecay + sustain) : max_level_t;
+        }
+        return;
+    case Stage::Release:
+        for (auto&& value : levels) {
+            value = level = DecayTable::lookupInterpolate(&progress, increment);
+        }
+        return;
+    case Stage::Sustain:
+        // in case it's changed by live updating
+        level = sustain;
+        break;
+    default:
+        break;
+    }
+    // Constant level
+    std::ranges::fill(levels, level);
+}
+
+void Envelope::genNextBlockExact(std::span<level_t> levels)
+{
+    while (!levels.empty()) {
+        if (segmentLeft == 0) {
+            segmentLeft = getSegmentLength();
+            if (segmentLeft == 0) {
+                // This sample could end the stage so do the full check
+                levels[0] = genNextOutputExact();
+                levels = levels.subspan(1);
+                continue;
+            }
+        }
+        std::size_t n = std::min(std::size_t(segmentLeft), levels.size());
+        renderSegment(levels.first(n));
+        if (segmentLeft != segmentUnlimited) {
+            segmentLeft -= unsigned(n);
+        }
+        levels = levels.subspan(n);
+    }
+}
+
+unsigned Envelope::getRampLength(unsigned period) const
+{
+    // The samples skipped by a ramp must be ones where the stage can't end.
+    // The last sample of the ramp is done by the real doStage() call, which
+    // sees the values from the start of the ramp, so it must also be one
+    // where the stage can't end unless it is the only sample.
+    return std::clamp(getSegmentLength(), 1u, period);
+}
+
+void Envelope::startRamp(unsigned period)
+{
+    // Clear the flag before reading any of the envelope state, so that a gate
+    // event from here on sets it again and restarts the ramp on the next sample
+    rampRestart = false;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    unsigned n = getRampLength(period);
+    // Advance to the last sample in the ramp and evaluate it exactly
+    rate_t skip = (n - 1) * increment;
+    if (stage == Stage::Delay) {
+        delayProgress += skip;
+        if (level > 0)
+            progress += skip;
+    } else if (stage != Stage::Sustain && stage != Stage::Idle) {
+        progress += skip;
+    }
+    level_t levelStart = level;
+    (this->*doStageFunction)();
+    rampTarget = level;
+    level = levelStart;
+    rampCount = n;
+    // 15 fraction bits so that a full-scale difference fits in an int32_t
+    rampLevel = int32_t(levelStart) << 15;
+    rampStep = ((int32_t(rampTarget) - int32_t(levelStart)) << 15) / int32_t(n);
 }
 
-template<Envelope::Stage stage>
+template<Envelope::Stage stageNew>
 void Envelope::setStage()
 {
-    doStageFunction = &Envelope::doStage<stage>;
-    initStage<stage>();
+    stage = stageNew;
+    doStageFunction = &Envelope::doStage<stageNew>;
+    // Any segment in progress is no longer valid
+    segmentLeft = 0;
+    initStage<stageNew>();
 }
 
 template<>
@@ -285,7 +481,7 @@ void Envelope::doStage<Envelope::Stage::Release>()
             // loop mode - restart the envelope
             setStage<Stage::Delay>();
         } else {
-            stopEnvelope();
+            setStage<Stage::Idle>();
         }
     } else {
         // lookupInterpolate() takes care of incrementing progress.
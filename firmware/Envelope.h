@@ -53,6 +53,34 @@ public:
     /// @brief Set envelope parameters
     void setParams(const Patches::EnvParams& params);
 
+    /// @brief Current position in the current envelope stage
+    /// @details Actually the same as Dexy::phase_t.
+    using progress_t = phase_t;
+
+    /// @brief Rate at which the envelope is changing
+    /// @details Actually the same as Dexy::phase_t.
+    /// @todo Put this in Defs.h and use it wherever phase_t is actually an increment
+    using rate_t = phase_t;
+
+    /// @brief Envelope settings converted from EnvParams, ready to be used by
+    /// setSettings()
+    struct Settings
+    {
+        rate_t delay = 0;
+        rate_t attack = 0;
+        rate_t decay = 0;
+        level_t sustain = max_level_t;
+        rate_t release = 0;
+        bool loop = false;
+    };
+
+    /// @brief Convert envelope parameters to Settings
+    /// @details This does the table lookups, so setSettings() is just a copy.
+    static Settings makeSettings(const Patches::EnvParams& params);
+
+    /// @brief Set envelope settings that were converted by makeSettings()
+    void setSettings(const Settings& settings);
+
     /// @brief Gate start signal has been received - Start the envelope running
     void gateStart();
 
@@ -60,19 +88,72 @@ public:
     void gateStop();
 
     /// @brief Generate the next envelope value
-    level_t genNextOutput();
+    /// @details Calls genNextOutputExact() or genNextOutputRamped(),
+    /// depending on ENVELOPE_CONTROL_RATE.
+    level_t genNextOutput()
+    {
+#ifdef ENVELOPE_CONTROL_RATE
+        return genNextOutputRamped(ENVELOPE_CONTROL_RATE);
+#else
+        return genNextOutputExact();
+#endif
+    }
+
+    /// @brief Generate the next envelope value by evaluating the envelope curve
+    level_t genNextOutputExact();
+
+    /// @brief Generate the next envelope value, evaluating the envelope curve
+    /// only every few samples and ramping linearly in between
+    /// @details Each ramp ends on a value of the exact envelope curve, and is
+    /// cut short so that stage transitions happen on the same sample as with
+    /// genNextOutputExact(). Don't mix calls to this and genNextOutputExact()
+    /// on the same Envelope.
+    /// @param period Maximum number of samples per ramp
+    level_t genNextOutputRamped(unsigned period)
+    {
+        if (rampCount == 0 || rampRestart) {
+            startRamp(period);
+        }
+        --rampCount;
+        rampLevel += rampStep;
+        level = (rampCount == 0) ? rampTarget : level_t(rampLevel >> 15);
+        return level;
+    }
+
+    /// @brief Generate a block of envelope values
+    /// @details Same result as calling genNextOutput() for each value, but
+    /// without ENVELOPE_CONTROL_RATE the block is rendered in segments
+    /// during which the envelope stage can't change, so most values are
+    /// calculated without checking for the end of the stage.
+    /// @param[out] levels Buffer to fill with envelope levels
+    void genNextBlock(std::span<level_t> levels)
+    {
+#ifdef ENVELOPE_CONTROL_RATE
+        for (auto&& value : levels) {
+            value = genNextOutputRamped(ENVELOPE_CONTROL_RATE);
+        }
+#else
+        genNextBlockExact(levels);
+#endif
+    }
+
+    /// @brief Generate a block of envelope values by evaluating the envelope
+    /// curve in segments
+    /// @details Same result as calling genNextOutputExact() for each value.
+    /// @param[out] levels Buffer to fill with envelope levels
+    void genNextBlockExact(std::span<level_t> levels);
 
     /// @brief Stop the envelope and return to idle state
     void stopEnvelope();
 
-    /// @brief Current position in the current envelope stage
-    /// @details Actually the same as Dexy::phase_t.
-    using progress_t = phase_t;
+    /// @brief Is the envelope idle?
+    /// @details An idle envelope's level is 0 and stays there until the next
+    /// gateStart().
+    bool isIdle() const;
 
-    /// @brief Rate at which the envelope is changing
-    /// @details Actually the same as Dexy::phase_t.
-    /// @todo Put this in Defs.h and use it wherever phase_t is actually an increment
-    using rate_t = phase_t;
+    /// @brief Get the current envelope level
+    /// @return The level most recently generated
+    level_t getLevel() const;
 
 private:
     // Envelope settings - based on EnvParams but stored as implementation-
@@ -91,10 +172,30 @@ private:
     level_t level = 0;          ///< Current envelope level
     bool gateOn = false;        ///< Is the gate on? - used for looping
 
+    /// @brief Number of samples that genNextBlockExact() can render before
+    /// checking for the end of the stage, or 0 if it needs to be calculated
+    unsigned segmentLeft = 0;
+
+    // Ramp state for genNextOutputRamped()
+    unsigned rampCount = 0;     ///< Samples left in the current ramp
+    int32_t rampLevel = 0;      ///< Ramped level with 15 fraction bits
+    int32_t rampStep = 0;       ///< Amount added to rampLevel each sample
+    level_t rampTarget = 0;     ///< Level at the end of the current ramp
+
+    /// @brief Set by gateStart(), gateStop() and stopEnvelope() when the
+    /// current ramp is no longer valid
+    /// @details The gate functions can be called from an interrupt handler in
+    /// the middle of genNextOutputRamped(), so they must not change the other
+    /// ramp state. The new ramp starts on the next sample.
+    volatile bool rampRestart = false;
+
     /// @brief Envelope stages
     /// @details Each envelope stage has an init function and a do function
     enum class Stage { Idle, Delay, Attack, Decay, Sustain, Release };
 
+    /// @brief The current Stage
+    Stage stage = Stage::Idle;
+
     /// @brief Set the envelope stage
     template<Stage stage> void setStage();
 
@@ -122,6 +223,33 @@ private:
 
     /// @brief Placeholder to initialize doStageFunction
     void doNothing() { }
+
+    /// @brief Length of a segment that never ends, for stages that don't
+    /// change by themselves
+    static constexpr unsigned segmentUnlimited = std::numeric_limits<unsigned>::max();
+
+    /// @brief How many samples there are before the current stage could end
+    /// @details For each of these samples doStage() would definitely not end
+    /// the stage, so they can be rendered by renderSegment() without
+    /// checking.
+    /// @return Number of samples, possibly 0 or segmentUnlimited
+    unsigned getSegmentLength() const;
+
+    /// @brief Render samples within a segment without checking for the end
+    /// of the stage
+    /// @param[out] levels Buffer to fill - size must be <= segment length
+    void renderSegment(std::span<level_t> levels);
+
+    /// @brief How many samples the next ramp can cover without missing a
+    /// stage transition
+    /// @param period Maximum number of samples
+    /// @return Number of samples, 1 to period
+    unsigned getRampLength(unsigned period) const;
+
+    /// @brief Evaluate the envelope at the end of the next ramp and set up the
+    /// ramp to get there
+    /// @param period Maximum number of samples per ramp
+    void startRamp(unsigned period);
 };
 
 }
@@ -3,6 +3,9 @@ namespace Dexy { namespace IrqDispatch {
 static void onGpioInterrupt0(uint pin, uint32_t events);
 static void onGpioInterrupt1(uint pin, uint32_t events);
 static void onTimerInterrupt1();
+#ifdef DAC_OUTPUT_DMA
+static void onDmaInterrupt1();
+#endif
 
 IN_FLASH("IrqDispatch")
 void initCore0()
@@ -38,6 +41,12 @@ void initCore1()
     pwm_config_set_clkdiv_int_frac(&config, pwmClkDivInt, pwmClkDivFrac);
     pwm_config_set_phase_correct(&config, pwmPhaseCorrect);
     pwm_init(Gpio::pwmTimerSlice, &config, /*start*/ true);
+
+#ifdef DAC_OUTPUT_DMA
+    // DMA interrupts for the DAC output
+    irq_set_exclusive_handler(DMA_IRQ_0, onDmaInterrupt1);
+    irq_set_enabled(DMA_IRQ_0, true);
+#endif
 }
 
 /// @brief GPIO interrupt handler/dispatcher for core 0
@@ -94,4 +103,13 @@ static void onTimerInterrupt1()
     gpio_set_irqover(Gpio::pinCore0Timer, GPIO_OVERRIDE_LOW);
 }
 
+#ifdef DAC_OUTPUT_DMA
+/// @brief DMA interrupt handler for core 1
+static void onDmaInterrupt1()
+{
+    dassert(get_core_num() == 1, WrongCore);
+    SpiDac::onDmaInterrupt();
+}
+#endif
+
 } } // namespace IrqDispatch
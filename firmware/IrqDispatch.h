@@ -10,7 +10,7 @@ namespace IrqDispatch {
 /// Must be called by core 0 at startup.
 void initCore0();
 
-/// @brief Set up a handler/dispatcher for GPIO and PWM interrupts handled by core 1.
+/// @brief Set up a handler/dispatcher for GPIO, PWM and DMA interrupts handled by core 1.
 /// @details Specific pin interrupts are enabled in the appropriate places.
 /// Must be called by core 1 at startup.
 void initCore1();
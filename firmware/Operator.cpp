@@ -2,90 +2,112 @@ namespace Dexy {
 
 void Operator::setOpParams(const Patches::OpParams& params)
 {
-    fixedFreq = params.fixedFreq;
-    if (fixedFreq) {
-        // Set the operator's fixed pitch
-        setFrequency(SineWave::getIncrementForMidiNote(midiNote_t(params.noteOrFreq)));
+    setSettings(makeSettings(params));
+}
+
+Operator::Settings Operator::makeSettings(const Patches::OpParams& params)
+{
+    Settings settings;
+    settings.fixedFreq = params.fixedFreq;
+    if (settings.fixedFreq) {
+        // The operator's fixed pitch
+        settings.fixedIncrement = SineWave::getIncrementForMidiNoteFast(midiNote_t(params.noteOrFreq));
     } else {
-        // Set operator's frequency ratio, to be used to set the frequency when running
-        freqRatio = freqRatio_t(params.noteOrFreq);
+        // Operator's frequency ratio, to be used to set the frequency when running
+        settings.freqRatio = freqRatio_t(params.noteOrFreq);
     }
     // TODO: Scale this down to give headroom for modulation
-    outputLevel = levelFromParam(params.outputLevel);
-    useEnvelope = params.useEnvelope;
-    ampModSens = params.ampModSens;
+    settings.outputLevel = levelFromParam(params.outputLevel);
+    settings.useEnvelope = params.useEnvelope;
+    settings.ampModSens = params.ampModSens;
     // params includes the envelope parameters
-    env.setParams(params.env);
+    settings.env = Envelope::makeSettings(params.env);
+    return settings;
+}
+
+void Operator::setSettings(const Settings& settings)
+{
+    auto& cold = bank->cold[index];
+    cold.fixedFreq = settings.fixedFreq;
+    if (cold.fixedFreq) {
+        setFrequency(settings.fixedIncrement);
+    } else {
+        cold.freqRatio = settings.freqRatio;
+        // The note pitch may not change again for a while so apply the new ratio now
+        setFrequency(scalePitch(cold.notePitch, cold.freqRatio));
+    }
+    bank->outputLevel[index] = settings.outputLevel;
+    bank->useEnvelope[index] = settings.useEnvelope;
+    cold.ampModSens = settings.ampModSens;
+    updateGain();
+    bank->env[index].setSettings(settings.env);
+}
+
+void Operator::setAmpMod(output_t ampMod)
+{
+    auto& cold = bank->cold[index];
+    if (ampMod != cold.ampMod) {
+        cold.ampMod = ampMod;
+        updateGain();
+    }
+}
+
+void Operator::updateGain()
+{
+    const auto& cold = bank->cold[index];
+#ifdef OPERATOR_FOLDED_GAIN
+    bank->gain[index] = calcGain(bank->outputLevel[index], cold.ampModSens, cold.ampMod);
+#else
+    bank->ampModLevel[index] = calcAmpModLevel(cold.ampModSens, cold.ampMod);
+#endif
 }
 
 void Operator::setNotePitch(phase_t pitch)
 {
-    if (!fixedFreq) {
-        // Multiply pitch by frequency ratio. This requires 64-bit arithmetic.
-        // freqRatio is fixed-point, 5-bit int + 11-bit fraction.
-        uint64_t temp = uint64_t(pitch) * uint64_t(freqRatio);
-        pitch = phase_t(temp >> 11);
-        setFrequency(pitch);
+    auto& cold = bank->cold[index];
+    cold.notePitch = pitch;
+    if (!cold.fixedFreq) {
+        // Multiply pitch by frequency ratio
+        setFrequency(scalePitch(pitch, cold.freqRatio));
         // TODO: Keyboard (pitch) level scaling - per-op break, curve, amount; see Complete DX7
     }
 }
 
 void Operator::setFrequency(phase_t pitch)
 {
-    sineWave.setIncrement(pitch);
+    bank->increment[index] = pitch;
 }
 
 void Operator::gateStart()
 {
-    env.gateStart();
+    bank->env[index].gateStart();
 }
 
 void Operator::gateStop()
 {
-    env.gateStop();
+    bank->env[index].gateStop();
 }
 
 void Operator::resetWave()
 {
-    sineWave.reset();
+    bank->phase[index] = 0;
 }
 
-/// @brief Adjust the Operator's output according to the given level setting
-/// @param amplitude Output amplitude
-/// @param level Level setting
-/// @return Adjusted output amplitude
-static output_t adjustOutputLevel(output_t amplitude, level_t level)
+output_t Operator::genNextOutput(output_t freqMod)
 {
-    int32_t output32 = int32_t(amplitude) * int32_t(level + 1);
-    return output_t(output32 >> 16);
-}
-
-output_t Operator::genNextOutput(output_t freqMod, output_t ampMod)
-{
-    // Sine oscillator
-    output_t output = sineWave.genNextOutput(freqMod);
-    // Apply envelope to amplitude
-    if (useEnvelope) {
-        output = adjustOutputLevel(output, env.genNextOutput());
-    }
-    // Apply amplitude modulation
-    level_t level = max_level_t;
-    level = level_t(int32_t(ampModSens) * int32_t(ampMod) / 1024
-                            + (65535 - int32_t(ampModSens) * 32));
-    output = adjustOutputLevel(output, level);
-    // Apply operator output level
-    output = adjustOutputLevel(output, outputLevel);
-    return output;
+    return genNextOutput(freqMod,
+                         bank->useEnvelope[index] ? bank->env[index].genNextOutput() : max_level_t);
 }
 
 /// @brief Lookup table to map a level parameter (param_t) to an actual level (level_t).
-static constexpr DataTable<level_t, max_param_t+1,
+/// @details Every 8th entry is stored, within 0.1% (0.009 dB).
+static constexpr InterpolatedDataTable<level_t, max_param_t+1, 8,
     [](std::size_t index, [[maybe_unused]] std::size_t numValues) {
         // This function must map index 0 -> value 0 and
         // index max_param_t -> value max_level_t
         double value = std::round(std::exp(index * 0.00775) * 23.6285 - 24);
         return level_t(value);
-    }> expLevelMap;
+    }, 0.001> expLevelMap;
 
 constexpr level_t Operator::levelFromParam(param_t param)
 {
@@ -2,19 +2,56 @@
 
 namespace Dexy {
 
+class OperatorBank;
+
 /// @brief An FM synth operator, consisting of a sine wave oscillator and an envelope
 /// generator
+/// @details An Operator is a view of one operator's state in an OperatorBank,
+/// which stores the state of all the operators. Operators are small and
+/// cheap to copy.
 class Operator
 {
 public:
+    /// @brief Ctor makes a view of one operator in an OperatorBank
+    /// @param opBank The OperatorBank
+    /// @param iOp Index of the operator in opBank
+    Operator(OperatorBank& opBank, unsigned iOp) : bank(&opBank), index(iOp) { }
+
     /// @brief Set this Operator's settings based on the currently selected
     /// Dexy::Patches::Patch
     /// @param params Operator settings from the Patch
     void setOpParams(const Patches::OpParams& params);
 
+    /// @brief Operator settings converted from OpParams, ready to be used by
+    /// setSettings()
+    struct Settings
+    {
+        bool fixedFreq = false;
+        freqRatio_t freqRatio = freqRatio1;
+        phase_t fixedIncrement = 0;     ///< Wavetable increment if fixedFreq
+        level_t outputLevel = max_level_t;
+        bool useEnvelope = true;
+        param_t ampModSens = 0;
+        Envelope::Settings env;
+    };
+
+    /// @brief Convert operator parameters to Settings
+    /// @details This does all the table lookups and conversions, so it can be
+    /// done ahead of time on a different core than the one that calls
+    /// setSettings().
+    /// @param params Operator settings from the Patch
+    static Settings makeSettings(const Patches::OpParams& params);
+
+    /// @brief Set this Operator's settings from the output of makeSettings()
+    /// @details This only copies values, plus a multiply to set the frequency.
+    /// @param settings
+    void setSettings(const Settings& settings);
+
     /// @brief Set this Operator's frequency based on the note pitch (derived
     /// from a CV input).
     /// @details This uses freqRatio and doesn't affect a fixed-frequency operator.
+    /// The pitch is remembered so the frequency can be recalculated when
+    /// the Operator's settings change.
     /// @param pitch Fundamental note frequency, represented as a Dexy::phase_t
     void setNotePitch(phase_t pitch);
 
@@ -25,7 +62,7 @@ public:
 
     /// @brief Get this Operator's specified output level.
     /// @return The Operator's output level
-    level_t getOutputLevel() const { return outputLevel; }
+    level_t getOutputLevel() const;
 
     /// @brief Gate start signal has been received - Start playing a note
     void gateStart();
@@ -38,29 +75,246 @@ public:
     /// live updating.
     void resetWave();
 
+    /// @brief Set the amplitude modulation value
+    /// @details The amplitude modulation level is only recalculated when the
+    /// value changes, not for every sample. With OPERATOR_FOLDED_GAIN it is
+    /// combined with the output level into one gain.
+    /// @param ampMod Amplitude modulation value
+    void setAmpMod(output_t ampMod);
+
     /// @brief Generate the Operator's next output value by advancing both the
     /// waveform and the envelope.
     /// @param freqMod Frequency modulation value
-    /// @param ampMod Amplitude modulation value
     /// @return The Operator's output value
-    output_t genNextOutput(output_t freqMod, output_t ampMod);
+    output_t genNextOutput(output_t freqMod);
+
+    /// @brief Generate the Operator's next output value by advancing the
+    /// waveform, using an envelope level from genEnvelopeBlock()
+    /// @param freqMod Frequency modulation value
+    /// @param envLevel Envelope level for this sample
+    /// @return The Operator's output value
+    output_t genNextOutput(output_t freqMod, level_t envLevel);
+
+    /// @brief Generate a block of envelope levels to be passed to
+    /// genNextOutput() one at a time
+    /// @details The envelope isn't advanced if the Operator doesn't use it.
+    /// @param[out] levels Buffer to fill with envelope levels
+    void genEnvelopeBlock(std::span<level_t> levels);
+
+    /// @brief Advance the waveform by one sample without calculating an
+    /// output value
+    /// @details This is used instead of genNextOutput() when the output isn't
+    /// needed. The phase stays exactly where it would have been. The envelope
+    /// is advanced separately by genEnvelopeBlock().
+    void skipNextOutput();
+
+    /// @brief Get this Operator's current level, based on its envelope
+    /// level and its output level but not amplitude modulation
+    /// @return The Operator's current level
+    level_t getCurrentLevel() const;
+
+    /// @brief Is the Operator making any sound?
+    /// @details An Operator is silent if its output level is 0 or its
+    /// envelope is idle. The output of a silent Operator is (almost) 0 so it
+    /// doesn't need to be calculated.
+    bool isAudible() const;
+
+    /// @brief Multiply a pitch by a frequency ratio
+    /// @details Same result as the 64-bit product (pitch * ratio) >> 11,
+    /// truncated to 32 bits, but uses only 32-bit multiplies which the M0+
+    /// does in hardware. The pitch is split into high and low parts:
+    /// (hi * 2^12 + lo) * ratio >> 11 == hi * ratio * 2 + (lo * ratio >> 11)
+    /// exactly, because lo * ratio fits in 28 bits and the first term
+    /// has no fraction bits to lose.
+    /// @param pitch Pitch represented as a Dexy::phase_t
+    /// @param ratio Frequency ratio, 5-bit int + 11-bit fraction
+    /// @return Scaled pitch
+    static constexpr phase_t scalePitch(phase_t pitch, freqRatio_t ratio)
+    {
+        uint32_t pitchHi = pitch >> 12;
+        uint32_t pitchLo = pitch & mask_low_bits(12);
+        return phase_t(pitchHi * ratio * 2 + ((pitchLo * ratio) >> 11));
+    }
 
     /// @brief Helper function to scale the output level setting
     /// @param param Output level setting
     /// @return The output level corresponding to param
     static constexpr level_t levelFromParam(param_t param);
 
+    /// @brief Calculate the level for an amplitude modulation value
+    /// @param ampModSens Operator sensitivity to amplitude modulation
+    /// @param ampMod Amplitude modulation value
+    /// @return Amplitude modulation level
+    static constexpr level_t calcAmpModLevel(param_t ampModSens, output_t ampMod)
+    {
+        return level_t(ampModSens * int32_t(ampMod) / 1024 + (65535 - ampModSens * 32));
+    }
+
+    /// @brief Adjust the Operator's output according to the given level setting
+    /// @param amplitude Output amplitude
+    /// @param level Level setting
+    /// @return Adjusted output amplitude
+    static constexpr output_t adjustOutputLevel(output_t amplitude, level_t level)
+    {
+        int32_t output32 = int32_t(amplitude) * int32_t(level + 1);
+        return output_t(output32 >> 16);
+    }
+
+    /// @brief Number of fraction bits in a gain from calcGain()
+    static constexpr unsigned cbitsGain = 15;
+
+    /// @brief Combine the amplitude modulation and the output level into one
+    /// gain, for OPERATOR_FOLDED_GAIN
+    /// @details This is the part of an Operator's level that doesn't change
+    /// from sample to sample. It has cbitsGain fraction bits, so it is 1.0
+    /// (1 << cbitsGain) when ampMod has no effect and outputLevel is
+    /// max_level_t.
+    /// @param outputLevel Operator output level
+    /// @param ampModSens Operator sensitivity to amplitude modulation
+    /// @param ampMod Amplitude modulation value
+    /// @return Combined gain
+    static constexpr uint16_t calcGain(level_t outputLevel, param_t ampModSens, output_t ampMod)
+    {
+        // x * y can be 2^32, so take (x * y) >> 1 as
+        // x * (y >> 1) + (x >> 1) * (y & 1), which fits in 32 bits
+        uint32_t x = uint32_t(calcAmpModLevel(ampModSens, ampMod)) + 1;
+        uint32_t y = uint32_t(outputLevel) + 1;
+        return uint16_t((x * (y >> 1) + (x >> 1) * (y & 1)) >> (32 - cbitsGain - 1));
+    }
+
+    /// @brief Apply an envelope level and a gain from calcGain() to the
+    /// Operator's output, for OPERATOR_FOLDED_GAIN
+    /// @details The envelope level is scaled by the gain first so that the
+    /// output takes a single multiply. This is not bit-exact with scaling the
+    /// output by the three levels one after another, which truncates three
+    /// times: it is within -2..+3 of that (see GainStagingBench), and the
+    /// output is unchanged when all the levels are at maximum.
+    /// @param amplitude Output amplitude
+    /// @param envLevel Envelope level
+    /// @param gain Gain from calcGain()
+    /// @return Adjusted output amplitude
+    static constexpr output_t applyGain(output_t amplitude, level_t envLevel, uint16_t gain)
+    {
+        // (envLevel + 1) * gain fits in 32 bits because gain <= 1 << cbitsGain
+        uint32_t factor = ((uint32_t(envLevel) + 1) * gain) >> cbitsGain;
+        return output_t((int32_t(amplitude) * int32_t(factor)) >> 16);
+    }
+
 private:
-    // Operator settings - based on Dexy::Patches::OpParams but stored as
-    // implementation-friendly types
-    bool fixedFreq = false;             ///< Operator freq is fixed or set by pitch CV
-    freqRatio_t freqRatio = freqRatio1; ///< Frequency ratio (only if fixedFreq = false)
-    level_t outputLevel = max_level_t;  ///< Operator output level (nominal maximum)
-    bool useEnvelope = true;            ///< Is outputLevel modulated by the envelope?
-    param_t ampModSens = 0;             ///< Operator sensitivity to amplitude modulation
-
-    SineWave::WaveGen sineWave;         ///< The Operator's sine wave oscillator
-    Envelope env;                       ///< The Operator's envelope generator
+    /// @brief Recalculate the amplitude modulation level (or the gain) after
+    /// the output level or amplitude modulation has changed
+    void updateGain();
+
+    OperatorBank* bank; ///< Where the operator's state is stored
+    unsigned index;     ///< Index of the operator in bank
 };
 
+/// @brief Storage for the state of a set of Operators
+/// @details The state that is used for every sample is stored as a structure
+/// of arrays, so that it is densely packed and each field is at a fixed
+/// offset from the start of its array. The patch settings that are only used
+/// when the patch or note pitch changes are stored separately.
+///
+/// The envelopes are stored as an array of Envelope objects. Each one is a
+/// state machine with its own stage, so they aren't calculated together.
+/// They are rendered a block at a time by Operator::genEnvelopeBlock(), and
+/// the render loop reads the levels from those blocks.
+class OperatorBank
+{
+public:
+    /// @brief Get an Operator
+    /// @param index Operator index
+    /// @return A view of the Operator
+    Operator operator[](unsigned index) { return Operator(*this, index); }
+
+    /// @brief Number of Operators
+    static constexpr unsigned size() { return numOperators; }
+
+    /// @brief All the Operators, as a range of views
+    auto all() { return std::views::iota(0u, size())
+        | std::views::transform([this](unsigned i) { return Operator(*this, i); }); }
+
+private:
+    friend class Operator;
+
+    // Operator state used for every sample
+    std::array<phase_t, numOperators> phase = {};     ///< Sine wave phase (see SineWave::WaveGen)
+    std::array<phase_t, numOperators> increment = filledArray<phase_t, numOperators>(1); ///< Sine wave increment (see SineWave::WaveGen)
+    std::array<level_t, numOperators> outputLevel = filledArray<level_t, numOperators>(max_level_t); ///< Operator output level (nominal maximum)
+#ifdef OPERATOR_FOLDED_GAIN
+    std::array<uint16_t, numOperators> gain = filledArray<uint16_t, numOperators>(1u << Operator::cbitsGain); ///< Combined output level & amplitude modulation (see Operator::calcGain())
+#else
+    std::array<level_t, numOperators> ampModLevel = filledArray<level_t, numOperators>(max_level_t); ///< Amplitude modulation level (see Operator::calcAmpModLevel())
+#endif
+    std::array<bool, numOperators> useEnvelope = filledArray<bool, numOperators>(true); ///< Is outputLevel modulated by the envelope?
+
+    /// @brief Operator settings that aren't used for every sample - based on
+    /// Dexy::Patches::OpParams but stored as implementation-friendly types
+    struct ColdSettings
+    {
+        bool fixedFreq = false;             ///< Operator freq is fixed or set by pitch CV
+        freqRatio_t freqRatio = freqRatio1; ///< Frequency ratio (only if fixedFreq = false)
+        phase_t notePitch = 0;              ///< Last note pitch from setNotePitch()
+        param_t ampModSens = 0;             ///< Operator sensitivity to amplitude modulation
+        output_t ampMod = 0;                ///< Last amplitude modulation value from setAmpMod()
+    };
+    std::array<ColdSettings, numOperators> cold = {};
+
+    std::array<Envelope, numOperators> env = {}; ///< The Operators' envelope generators
+
+    /// @brief Fill a std::array with one value, for member initializers
+    template<typename T, std::size_t N>
+    static constexpr std::array<T, N> filledArray(T value)
+    {
+        std::array<T, N> arr;
+        arr.fill(value);
+        return arr;
+    }
+};
+
+inline level_t Operator::getOutputLevel() const { return bank->outputLevel[index]; }
+
+inline void Operator::genEnvelopeBlock(std::span<level_t> levels)
+{
+    if (bank->useEnvelope[index]) {
+        bank->env[index].genNextBlock(levels);
+    }
+}
+
+inline output_t Operator::genNextOutput(output_t freqMod, level_t envLevel)
+{
+    // Sine oscillator
+    output_t output = SineWave::genNextOutput(&bank->phase[index], bank->increment[index], freqMod);
+#ifdef OPERATOR_FOLDED_GAIN
+    // Apply envelope, amplitude modulation and output level
+    if (!bank->useEnvelope[index]) {
+        envLevel = max_level_t;
+    }
+    return applyGain(output, envLevel, bank->gain[index]);
+#else
+    // Apply envelope to amplitude
+    if (bank->useEnvelope[index]) {
+        output = adjustOutputLevel(output, envLevel);
+    }
+    // Apply amplitude modulation
+    output = adjustOutputLevel(output, bank->ampModLevel[index]);
+    // Apply operator output level
+    output = adjustOutputLevel(output, bank->outputLevel[index]);
+    return output;
+#endif
+}
+
+inline void Operator::skipNextOutput() { bank->phase[index] += bank->increment[index]; }
+
+inline level_t Operator::getCurrentLevel() const
+{
+    level_t envLevel = bank->useEnvelope[index] ? bank->env[index].getLevel() : max_level_t;
+    return level_t((uint32_t(envLevel) * (uint32_t(bank->outputLevel[index]) + 1)) >> 16);
+}
+
+inline bool Operator::isAudible() const
+{
+    return bank->outputLevel[index] != 0 && !(bank->useEnvelope[index] && bank->env[index].isIdle());
+}
+
 }
@@ -16,3 +16,9 @@
 #include "hardware/adc.h"
 #include "hardware/flash.h"
 #include "hardware/watchdog.h"
+#ifdef DAC_OUTPUT_DMA
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "DacSpi.pio.h" // generated from DacSpi.pio
+#endif
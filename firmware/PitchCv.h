@@ -0,0 +1,46 @@
+#pragma once
+
+namespace Dexy {
+
+/// @brief Reversals in the pitch CV input up to this size (in ADC units) are ignored
+/// @details One ADC unit is about 3 cents. The ADC reading jitters by about
+/// +/-1 unit even with a steady CV.
+/// @see Hysteresis
+constexpr uint16_t pitchCvHysteresis = 2;
+
+/// @brief Pitch CV input processing: smoothing and change detection
+/// @details Core0::onTimerInterrupt() passes every pitch CV reading to
+/// update(), which sets the synth's note pitch only when the filtered reading
+/// has changed. Otherwise every operator's frequency would be recalculated on
+/// every sample. This has no hardware dependencies, so the host build can run
+/// (and benchmark) the same code.
+/// @tparam ADC_RESULT Type of an ADC reading
+/// @tparam HYSTERESIS Reversals in the reading up to this size are ignored
+template<typename ADC_RESULT, ADC_RESULT HYSTERESIS>
+class PitchCv
+{
+public:
+    /// @brief Process a new pitch CV reading
+    /// @param adcPitch ADC reading of the pitch CV input
+    /// @param toIncrement Function to convert a filtered ADC reading to a
+    /// phase_t pitch, e.g. AdcMap::getIncrementForAdcValue()
+    /// @return true if the note pitch was changed
+    template<typename TO_INCREMENT>
+    bool update(ADC_RESULT adcPitch, TO_INCREMENT toIncrement)
+    {
+        // Average adcPitch with the previous value to provide some extra filtering
+        adcPitchPrev = getAndSet(adcPitch, ADC_RESULT((adcPitch + adcPitchPrev) / 2));
+        // Only update the pitch if it has changed by more than the noise level
+        if (!adcPitchFiltered.update(adcPitch)) {
+            return false;
+        }
+        Synth::setNotePitch(toIncrement(adcPitchFiltered.get()));
+        return true;
+    }
+
+private:
+    ADC_RESULT adcPitchPrev = 0;
+    Hysteresis<ADC_RESULT, HYSTERESIS> adcPitchFiltered{ std::numeric_limits<ADC_RESULT>::max() };
+};
+
+} // namespace Dexy
@@ -0,0 +1,120 @@
+// RingBuffer - Lock-free single-producer/single-consumer ring buffer
+
+#pragma once
+
+namespace Dexy {
+
+/// @brief Lock-free ring buffer for one producer and one consumer, which may be
+/// on different cores or in an interrupt handler
+/// @tparam T Type of the buffer entries
+/// @tparam SIZE Number of entries in the buffer - must be a power of 2
+///
+/// Usage
+/// -----
+/// @code
+/// RingBuffer<uint16_t, 32> buffer;
+///
+/// void producer()
+/// {
+///     while (!buffer.push(makeValue())) {
+///         // buffer is full - wait...
+///     }
+/// }
+///
+/// void consumer()
+/// {
+///     uint16_t value;
+///     if (buffer.pop(&value)) {
+///         useValue(value);
+///     } else {
+///         // buffer is empty
+///     }
+/// }
+/// @endcode
+///
+/// Notes
+/// -----
+/// The Cortex M0+ does not have atomic read-modify-write instructions, but it
+/// doesn't need them here. Each index is written by only one side (head by the
+/// producer, tail by the consumer) so plain 32-bit loads and stores with
+/// acquire/release ordering are enough. The indices run freely and wrap around;
+/// SIZE must be a power of 2 so that works out.
+///
+/// The buffer also keeps a low-water mark: the smallest number of entries that
+/// were available when the consumer took one (0 if it ever found the buffer
+/// empty). This shows how close the producer has come to falling behind.
+template<typename T, unsigned SIZE>
+class RingBuffer
+{
+public:
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "RingBuffer SIZE must be a power of 2");
+    static_assert(std::atomic<unsigned>::is_always_lock_free);
+
+    /// @brief Add a value to the buffer (producer only)
+    /// @param value
+    /// @return true if the value was added, false if the buffer is full
+    bool push(T value)
+    {
+        unsigned iHead = head.load(std::memory_order_relaxed);
+        if (iHead - tail.load(std::memory_order_acquire) >= SIZE) {
+            return false;
+        }
+        buffer[iHead & maskIndex] = value;
+        head.store(iHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Remove the oldest value from the buffer (consumer only)
+    /// @param[out] pvalue Value removed from the buffer
+    /// @return true if a value was removed, false if the buffer is empty
+    bool pop(T* pvalue)
+    {
+        unsigned iTail = tail.load(std::memory_order_relaxed);
+        unsigned count = head.load(std::memory_order_acquire) - iTail;
+        if (count < lowWaterMark.load(std::memory_order_relaxed)) {
+            lowWaterMark.store(count, std::memory_order_relaxed);
+        }
+        if (count == 0) {
+            return false;
+        }
+        *pvalue = buffer[iTail & maskIndex];
+        tail.store(iTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Number of entries currently in the buffer
+    /// @details This is only a snapshot if called while the other side is running.
+    unsigned count() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    /// @brief Is the buffer full?
+    bool isFull() const { return count() >= SIZE; }
+
+    /// @brief Is the buffer empty?
+    bool isEmpty() const { return count() == 0; }
+
+    /// @brief Buffer capacity
+    static constexpr unsigned capacity() { return SIZE; }
+
+    /// @brief Get the low-water mark
+    /// @return Smallest number of entries that were available to the consumer
+    /// since the last reset
+    unsigned getLowWaterMark() const { return lowWaterMark.load(std::memory_order_relaxed); }
+
+    /// @brief Reset the low-water mark
+    /// @details May be called from anywhere. If the consumer updates the mark at
+    /// the same moment, that one update may be lost, which is fine for a statistic.
+    void resetLowWaterMark() { lowWaterMark.store(SIZE, std::memory_order_relaxed); }
+
+private:
+    static constexpr unsigned maskIndex = SIZE - 1;
+
+    T buffer[SIZE] = {};                            ///< Buffer entries
+    std::atomic<unsigned> head = 0;                 ///< Next entry to write (producer)
+    std::atomic<unsigned> tail = 0;                 ///< Next entry to read (consumer)
+    std::atomic<unsigned> lowWaterMark = SIZE;      ///< See getLowWaterMark()
+};
+
+}
@@ -1,14 +1,5 @@
 namespace Dexy { namespace SineWave {
 
-/// @brief Sine wavetable
-using SineTable = WaveTable<output_t, sizeLookupTable,
-    [](std::size_t index, std::size_t numValues) {
-        constexpr output_t max = max_output_t;
-        double phase = 2 * std::numbers::pi / (numValues-1) * index;
-        double sine = std::sin(phase) * max;
-        return output_t(std::round(sine));
-    }>;
-
 void init()
 {
     static_assert(sizeof(modulation_t) == sizeof(phase_t));
@@ -31,39 +22,61 @@ constexpr phase_t getIncrementForMidiNote(midiNote_t note)
     return SineWave::getIncrementForHz(freqHz);
 }
 
-#if 0 // UNUSED
 // midiNoteTable - MIDI note frequency table
-// There is an extra entry at the end to help with interpolation.
+// The table covers only the top octave of the midiNote_t range. Lower notes
+// are calculated by shifting, because each octave down halves the increment.
+// There are 8 entries per semitone plus an extra entry at the end to help with
+// interpolation. Linear interpolation between entries 1/8 semitone apart has
+// a maximum relative error of about 7e-6 (0.01 cents).
 // NOTE: This relies on std::pow() being declared constexpr,
 // which it is in gcc but not in other compilers or the C++20 standard. :(
-static constexpr unsigned sizeMidiNoteTable = 1024;
+static constexpr unsigned midiNoteTableStepsPerSemitone = 8;
+static constexpr unsigned sizeMidiNoteTable = 12 * midiNoteTableStepsPerSemitone + 1;
+static constexpr int midiNoteOctave = 12 * midiNoteSemitone;
+static constexpr int midiNoteTableBase = max_midiNote_t + 1 - midiNoteOctave;
+static constexpr int min_midiNote_t = std::numeric_limits<midiNote_t>::min();
+static_assert(max_midiNote_t == std::numeric_limits<midiNote_t>::max(),
+    "midiNoteTable must cover the top of the midiNote_t range");
+/// @brief Number of midiNote_t fraction bits between table entries
+static constexpr unsigned cbitsMidiNoteStep = bits_in_num(midiNoteSemitone / midiNoteTableStepsPerSemitone) - 1;
+static_assert((1 << cbitsMidiNoteStep) * midiNoteTableStepsPerSemitone == midiNoteSemitone);
+/// @brief Table entries have extra fraction bits for precision in lower octaves
+static constexpr unsigned cbitsMidiNoteTableFraction = 8;
+
 static constexpr phase_t midiNoteCalc(std::size_t index, [[maybe_unused]]std::size_t numValues)
 {
-    // Table size = 1024, number of MIDI notes = 128
-    static_assert(sizeMidiNoteTable == 128 * 8);
-    double note = index / 8.0;
-    // Note #69 is A4 = 440 Hz
-    return getIncrementForHz(getHzForMidiNoteNumber(note));
+    double note = double(midiNoteTableBase) / midiNoteSemitone
+        + double(index) / midiNoteTableStepsPerSemitone;
+    // Exact increment, not rounded via freq_t like getIncrementForHz()
+    double increment = getHzForMidiNoteNumber(note) * (1 << cbitsPhase) / freqSample;
+    return phase_t(std::round(increment * (1 << cbitsMidiNoteTableFraction)));
 }
-static constexpr DataTable<phase_t, sizeMidiNoteTable+1, midiNoteCalc>
+static constexpr DataTable<phase_t, sizeMidiNoteTable, midiNoteCalc>
     midiNoteTable;
+static_assert(midiNoteTable[sizeMidiNoteTable-1] - midiNoteTable[sizeMidiNoteTable-2]
+        < (1u << (32 - cbitsMidiNoteStep)),
+    "midiNoteTable interpolation must not overflow");
 
-constexpr phase_t getIncrementForMidiNoteFast(midiNote_t note)
+phase_t getIncrementForMidiNoteFast(midiNote_t note)
 {
-    // NOTE: This version fails for note numbers out of range [0,128)
-    // TODO: assertion or error checking for that
-    unsigned index = (note >> 5) & 0x3FF;
+    // Every midiNote_t value is valid: count octaves down from the top octave,
+    // which is the one in the table.
+    unsigned noteFromTop = unsigned(max_midiNote_t - note);
+    unsigned octave = noteFromTop / midiNoteOctave;
+    unsigned noteInTable = unsigned(note - midiNoteTableBase) + octave * midiNoteOctave;
+    dassert(noteInTable < unsigned(midiNoteOctave), BadArgument);
+    unsigned index = noteInTable >> cbitsMidiNoteStep;
+    unsigned fraction = noteInTable & mask_low_bits(cbitsMidiNoteStep);
+    // Linear interpolation
     phase_t entry0 = midiNoteTable[index];
     phase_t entry1 = midiNoteTable[index+1];
-    phase_t value = entry0;
-    value = (value + ((note & 0x04) ? entry1 : entry0)) / 2;
-    value = (value + ((note & 0x08) ? entry1 : entry0)) / 2;
-    value = (value + ((note & 0x10) ? entry1 : entry0)) / 2;
-    return value;
+    phase_t value = entry0 + (((entry1 - entry0) * fraction) >> cbitsMidiNoteStep);
+    // Shift down to the right octave, with rounding
+    unsigned shift = cbitsMidiNoteTableFraction + octave;
+    return (value + (1u << (shift - 1))) >> shift;
 }
-#endif
 
-output_t WaveGen::genNextOutput(output_t modulation)
+output_t genNextOutput(phase_t* pPhase, phase_t increment, output_t modulation)
 {
     // Modulation Note: 16-bit amplitude is converted to a signed 24-bit phase
     // modulation value.
@@ -78,7 +91,7 @@ output_t WaveGen::genNextOutput(output_t modulation)
 
     // Update the wave state to the next sample, using table lookup & interpolation.
     // This is where the modulation value is added.
-    return SineTable::lookupInterpolate(&phase, increment, modulation << 12);
+    return SineTable::lookupInterpolate(pPhase, increment, modulation << 12);
 }
 
 } } // namespace SineWave
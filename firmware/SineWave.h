@@ -25,6 +25,48 @@ constexpr unsigned freqSample = 49152;
 /// @brief Initialization - must be called at startup
 void init();
 
+/// @brief Calculate a sine wavetable entry
+/// @param index Table index
+/// @param numValues Number of entries, including the extra one at the end
+/// @return Sine value
+constexpr output_t calcSineEntry(std::size_t index, std::size_t numValues)
+{
+    constexpr output_t max = max_output_t;
+    double phase = 2 * std::numbers::pi / (numValues-1) * index;
+    double sine = std::sin(phase) * max;
+    return output_t(std::round(sine));
+}
+
+/// @brief Calculate a quarter-wave sine table entry (see QuarterWaveTable)
+/// @param index Table index
+/// @param numValues Number of entries, including the extra one at the end
+/// @return Sine value
+constexpr output_t calcQuarterSineEntry(std::size_t index, std::size_t numValues)
+{
+    constexpr output_t max = max_output_t;
+    double phase = std::numbers::pi / 2 / (numValues-1) * index;
+    double sine = std::sin(phase) * max;
+    return output_t(std::round(sine));
+}
+
+/// @brief Interpolation policy for the sine wavetable
+/// @details With WAVETABLE_HW_INTERP the hardware interpolators are set up by
+/// init(), which is called on core 1 by Synth::init().
+#ifdef WAVETABLE_HW_INTERP
+using SineInterpolate = Interpolate::Hardware;
+#else
+using SineInterpolate = Interpolate::Average3;
+#endif
+
+/// @brief Sine wavetable, as used by genNextOutput()
+/// @details See host/bench/WaveTableBench for the cost and accuracy of the
+/// interpolation policies and table layouts.
+#ifdef SINE_QUARTER_WAVE
+using SineTable = QuarterWaveTable<output_t, cbitsLookupIndex, calcQuarterSineEntry, SineInterpolate>;
+#else
+using SineTable = WaveTable<output_t, sizeLookupTable, calcSineEntry, SineInterpolate>;
+#endif
+
 /// @brief Calculate the wavetable increment that gives a specified frequency
 /// @param freq Frequency (freq_t)
 /// @return Wavetable increment value (phase_t)
@@ -53,10 +95,30 @@ constexpr phase_t getIncrementForHz(auto freqHz)
 
 /// @brief Calculate the wavetable increment that gives a specified MIDI note
 /// @details This function works for positive and negative values of note.
+/// It uses double-precision floating point, so it should only be used at
+/// compile time. Use getIncrementForMidiNoteFast() at run time.
 /// @param note midiNote_t
 /// @return Wavetable increment value (phase_t)
 constexpr phase_t getIncrementForMidiNote(midiNote_t note);
 
+/// @brief Calculate the wavetable increment that gives a specified MIDI note,
+/// by table lookup and interpolation
+/// @details This works for any midiNote_t value, positive or negative, and
+/// uses only integer arithmetic. The result is within about 0.01 cents of
+/// the exact value, apart from the rounding to an integer phase_t.
+/// @param note midiNote_t
+/// @return Wavetable increment value (phase_t)
+phase_t getIncrementForMidiNoteFast(midiNote_t note);
+
+/// @brief Generate the next sample of a sine wave
+/// @details This is WaveGen::genNextOutput() for a phase and increment that
+/// are stored somewhere else, e.g. in an OperatorBank.
+/// @param[inout] pPhase Current phase of the wave, updated to the next sample
+/// @param increment Amount to increment the phase (related to frequency)
+/// @param modulation Phase modulation value
+/// @return output_t
+output_t genNextOutput(phase_t* pPhase, phase_t increment, output_t modulation);
+
 /// @brief Sine wave generator
 /// @details There can be multiple instances of WaveGen running at different
 // frequencies, but they all share the same wavetable.
@@ -70,7 +132,12 @@ public:
     /// @brief Generate the next wave sample
     /// @param modulation Phase modulation value 
     /// @return output_t
-    output_t genNextOutput(output_t modulation);
+    output_t genNextOutput(output_t modulation) { return SineWave::genNextOutput(&phase, increment, modulation); }
+
+    /// @brief Advance to the next wave sample without calculating it
+    /// @details Modulation only affects the wavetable lookup, not the phase,
+    /// so this keeps the phase the same as genNextOutput() would.
+    void skip() { phase += increment; }
 
     /// @brief Reset to the start of the wavetable
     void reset() { phase = 0; }
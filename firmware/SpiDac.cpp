@@ -1,28 +1,120 @@
 namespace Dexy { namespace SpiDac {
 
-// Settings for MCP482x
-static constexpr unsigned clkSpeed = 20000000;  ///< SPI clock speed
-static constexpr unsigned bitDacAB = 15;        ///< bit to select DAC unit A or B
-static constexpr unsigned bitDacGain = 13;      ///< bit to select gain: 0 = 2x, 1 = 1x
-static constexpr unsigned bitDacShutdown = 12;  ///< shutdown bit - active low
-static constexpr unsigned dacUnitA = 0;         ///< DAC unit A = 0
-static constexpr unsigned dacUnitB = 1;         ///< DAC unit B = 1
-
-/// @brief DAC command word - invariant part
-/// @details Always has gain = 1x and shutdown = nope.
-/// Gain must be set to 1x because the chip supply voltage (3.3V) is too low for 2x gain.
-static constexpr uint16_t wDacCmdBase = bitmask(bitDacGain, bitDacShutdown);
+using namespace Mcp482x;
 
-/// @brief DAC output buffer
-/// @details The output is stored in a buffer by setOutput() rather than being
-/// passed to sendToDac() directly.
-/// @todo Does this need to be protected by a CritSec?
-/// I don't think it's necessary and I want to avoid the overhead.
-static volatile dacdata_t output = 0;
+static constexpr unsigned clkSpeed = 20000000;  ///< SPI clock speed for MCP482x
+
+/// @brief Set the LED brightness to indicate the output value
+/// @param dacData DAC output data
+static void setLedLevel(dacdata_t dacData)
+{
+    // Adjust the value to give a better lightness curve
+    if constexpr (Gpio::pinLed != Gpio::pinNone) {
+        dacdata_t outputReduced = (dacData >> 8);
+        uint16_t pwmLedLevel = outputReduced * outputReduced;
+        if (pwmLedLevel >= 32768) {
+            pwmLedLevel -= 32768;
+        } else {
+            pwmLedLevel = 0;
+        }
+        pwm_set_gpio_level(Gpio::pinLed, pwmLedLevel);
+    }
+}
 
-/// @brief DAC output pending flag
-/// @todo CritSec?
-static volatile bool fOutputPending = false;
+#ifdef DAC_OUTPUT_DMA
+
+/// @brief DAC command words to be sent by DMA
+/// @details Output values are formatted and added by setOutput() on core 1.
+/// DMA sends one word to the dac_spi PIO program at each sample timer tick.
+static DacStream<outputBufferSize> outputStream(dacdataZero);
+
+static PIO dacPio = pio0;       ///< PIO block running the DAC programs
+static uint smSpi = 0;          ///< State machine running dac_spi
+static uint smLdac = 0;         ///< State machine running dac_ldac
+static uint dmaChannels[2];     ///< DMA channels that send each half of outputStream
+
+/// @brief Most recent output value, for the LED
+static std::atomic<dacdata_t> dacDataLast = dacdataZero;
+
+IN_FLASH("SpiDac")
+void init()
+{
+    // PIO programs: SCK is 1/4 of the PIO clock
+    float clkdiv = float(clock_get_hz(clk_sys)) / float(4 * clkSpeed);
+    smSpi = uint(pio_claim_unused_sm(dacPio, true));
+    smLdac = uint(pio_claim_unused_sm(dacPio, true));
+    dac_spi_program_init(dacPio, smSpi, pio_add_program(dacPio, &dac_spi_program),
+        Gpio::pinSpiSck, Gpio::pinSpiTx, Gpio::pinSpiCs1, clkdiv);
+    dac_ldac_program_init(dacPio, smLdac, pio_add_program(dacPio, &dac_ldac_program),
+        Gpio::pinSpiLdac, clkdiv);
+
+    // Two DMA channels send the two halves of outputStream alternately, each
+    // one chained to the other. Transfers are paced by the sample timer PWM
+    // slice so there is one command word per sample.
+    for (auto&& ch : dmaChannels) {
+        ch = uint(dma_claim_unused_channel(true));
+    }
+    for (unsigned i = 0; i < 2; ++i) {
+        dma_channel_config config = dma_channel_get_default_config(dmaChannels[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, true);
+        channel_config_set_write_increment(&config, false);
+        channel_config_set_dreq(&config, pwm_get_dreq(Gpio::pwmTimerSlice));
+        channel_config_set_chain_to(&config, dmaChannels[1 - i]);
+        dma_channel_configure(dmaChannels[i], &config, &dacPio->txf[smSpi],
+            outputStream.getHalf(i), outputStream.halfSize, /*trigger*/ false);
+        dma_channel_set_irq0_enabled(dmaChannels[i], true);
+    }
+    // Transfers start when IrqDispatch::initCore1() starts the PWM slice.
+    dma_channel_start(dmaChannels[0]);
+}
+
+void setOutput(dacdata_t value)
+{
+    while (!outputStream.write(value)) {
+        // waiting for DMA to finish sending the other half...
+    }
+    dacDataLast.store(value, std::memory_order_relaxed);
+}
+
+unsigned getBufferLowWaterMark()
+{
+    return outputStream.getLowWaterMark();
+}
+
+void resetBufferLowWaterMark()
+{
+    outputStream.resetLowWaterMark();
+}
+
+void onDmaInterrupt()
+{
+    for (unsigned i = 0; i < 2; ++i) {
+        if (dma_channel_get_irq0_status(dmaChannels[i])) {
+            dma_channel_acknowledge_irq0(dmaChannels[i]);
+            // The other channel is now running. Re-arm this one for when it's
+            // triggered by the other one finishing.
+            dma_channel_set_read_addr(dmaChannels[i], outputStream.getHalf(i), /*trigger*/ false);
+            if (!outputStream.onHalfSent(i)) {
+                // oh noes! DMA is re-sending stale output
+                Error::set<Error::Err::DataNotReady>();
+            }
+        }
+    }
+}
+
+void onOutputTimer()
+{
+    // The output is sent by DMA; only the LED is updated here.
+    setLedLevel(dacDataLast.load(std::memory_order_relaxed));
+}
+
+#else // DAC_OUTPUT_DMA
+
+/// @brief DAC output buffer
+/// @details Output values are queued by setOutput() on core 1 and removed by
+/// onOutputTimer(). The buffer is lock-free so neither side needs a CritSec.
+static RingBuffer<dacdata_t, outputBufferSize> outputBuffer;
 
 void init()
 {
@@ -38,42 +130,28 @@ void init()
     gpio_init(Gpio::pinSpiLdac);
     gpio_set_dir(Gpio::pinSpiLdac, GPIO_OUT);
     gpio_put(Gpio::pinSpiLdac, 0);
-    setOutput(SpiDac::dacdataZero);
+    // Start with half a buffer of silence, so that the timer interrupt has
+    // values to output until synthLoop() has generated its first block
+    for (unsigned i = 0; i < outputBufferSize / 2; ++i) {
+        setOutput(dacdataZero);
+    }
 }
 
 void setOutput(dacdata_t value)
 {
-    output = value;
-    fOutputPending = true;
-}
-
-// TODO: documentation from here
-
-/// @brief Get the pending DAC output value
-/// @return 
-static dacdata_t getOutput()
-{
-    return output;
-}
-
-/// @brief Is there a pending output value?
-/// @return Yes or no
-static bool isOutputPending()
-{
-    return fOutputPending;
+    while (!outputBuffer.push(value)) {
+        // waiting for the timer interrupt to make space...
+    }
 }
 
-/// @brief Reset the output-pending flag
-static void resetOutputPending()
+unsigned getBufferLowWaterMark()
 {
-    fOutputPending = false;
+    return outputBuffer.getLowWaterMark();
 }
 
-void waitForOutputSent()
+void resetBufferLowWaterMark()
 {
-    while (fOutputPending) {
-        // waiting...
-    }
+    outputBuffer.resetLowWaterMark();
 }
 
 /// @brief Send the given output value to the DAC via SPI
@@ -86,7 +164,7 @@ static void sendToDac(dacdata_t dacData, unsigned pinCS, unsigned dacUnit)
     gpio_put(Gpio::pinSpiLdac, 1);
     // Make up the SPI command word for the MCP4821/4822 DAC
     // dacData is the value to output - only the top 12 bits are used.
-    uint16_t wSpiData = dacdata_t(wDacCmdBase | (dacUnit << bitDacAB) | (dacData >> 4));
+    uint16_t wSpiData = makeCommand(dacData, dacUnit);
     // Assert CS. Do nops before & after for timing.
     asm volatile("nop \n nop \n nop");
     gpio_put(pinCS, 0); // Active low
@@ -103,32 +181,21 @@ static void sendToDac(dacdata_t dacData, unsigned pinCS, unsigned dacUnit)
 
 void onOutputTimer()
 {
-    // Check if the output data is ready (it should be!)
-    if (!isOutputPending()) {
+    // Get the data to be output from the buffer (it should be there!)
+    dacdata_t dacData;
+    if (!outputBuffer.pop(&dacData)) {
         // oh noes!
         Error::set<Error::Err::DataNotReady>();
     } else {
-        // Get the data to be output from the buffer and mark the buffer empty
-        // so the next value can be set as soon as it's ready.
-        dacdata_t dacData = getOutput();
-        resetOutputPending();
 
         // Send the output to the DAC (unit A)
         sendToDac(dacData, Gpio::pinSpiCs1, dacUnitA);
 
         // Set the LED brightness to indicate the output value
-        // Adjust the value to give a better lightness curve
-        if constexpr (Gpio::pinLed != Gpio::pinNone) {
-            dacdata_t outputReduced = (dacData >> 8);
-            uint16_t pwmLedLevel = outputReduced * outputReduced;
-            if (pwmLedLevel >= 32768) {
-                pwmLedLevel -= 32768;
-            } else {
-                pwmLedLevel = 0;
-            }
-            pwm_set_gpio_level(Gpio::pinLed, pwmLedLevel);
-        }
+        setLedLevel(dacData);
     }
 }
 
+#endif // DAC_OUTPUT_DMA
+
 } } // namespace SpiDac
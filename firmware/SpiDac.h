@@ -14,17 +14,38 @@ using dacdata_t = uint16_t;
 /// min and max values.
 constexpr dacdata_t dacdataZero = mid_value<SpiDac::dacdata_t>();
 
+/// @brief Number of output values that can be buffered ahead of the DAC
+/// @details A deeper buffer lets core 1 render further ahead to absorb timing
+/// jitter (e.g. patch loads) at the cost of more output latency. Must be a power of 2.
+/// With DAC_OUTPUT_DMA the buffer is sent by DMA in two halves.
+constexpr unsigned outputBufferSize = 32;
+
 /// @brief Initialization - must be called at startup
 void init();
 
-/// @brief Set the next DAC output value; it will be output at the next timer interrupt
+/// @brief Add a DAC output value to the output buffer; values are output at
+/// successive timer interrupts
+/// @details If the buffer is full this waits until there is space.
 /// @param value 
 void setOutput(dacdata_t value);
 
-/// @brief Wait until the previous pending output value has been sent to the DAC
-void waitForOutputSent();
+/// @brief Get the output buffer's low-water mark
+/// @return The smallest number of values that were waiting in the buffer when
+/// the timer interrupt needed one, since the last reset. 0 means that an output
+/// value was late. With DAC_OUTPUT_DMA this is only checked once per half-buffer.
+unsigned getBufferLowWaterMark();
+
+/// @brief Reset the output buffer's low-water mark
+void resetBufferLowWaterMark();
 
 /// @brief Timer interrupt handler - Output wave data to the DAC
+/// @details With DAC_OUTPUT_DMA the data is sent by DMA instead, and this only
+/// updates the LED.
 void onOutputTimer();
 
+#ifdef DAC_OUTPUT_DMA
+/// @brief DMA interrupt handler - called when DMA has sent half of the output buffer
+void onDmaInterrupt();
+#endif
+
 } } // namespace SpiDac
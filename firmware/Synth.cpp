@@ -6,14 +6,8 @@ static unsigned patchIndex = 0;
 /// @brief Name of the currently-playing patch
 static Patches::patchName_t patchName = {' '};
 
-/// @brief Array of Operator that make the sound!
-static Operator operators[numOperators];
-
-/// @brief The Algorithm that controls how the operators are combined
-static Algorithm algorithm = algorithms[0];
-
-/// @brief Feedback amount to use
-static param_t feedbackAmount = max_param_t;
+/// @brief The Voice that makes the sound!
+static Voice voice;
 
 /// @brief The current timbre (amplitude) modulation value
 /// @details This is set based on a CV input.
@@ -21,12 +15,44 @@ static output_t timbreMod = 0;
 
 #ifdef DEBUG_TEST_LFO
 /// @brief Operator to use as an LFO (for debugging only)
-static Operator opLfo;
+static OperatorBank lfoBank;
+static Operator opLfo = lfoBank[0];
 #endif
 
+/// @brief Number of gate start and stop events received
+/// @details These are only written by gateStart() and gateStop(), which are
+/// called by the gate interrupt handler on the same core as genNextBlock().
+/// The events are applied to the operators at the start of a block, because
+/// the envelopes must not change stage in the middle of rendering a block.
+static std::atomic<unsigned> gateStartCount = 0;
+static std::atomic<unsigned> gateStopCount = 0;
+
+/// @brief Was the most recent gate event a start?
+static std::atomic<bool> gateOnLast = false;
+
+/// @brief Number of gate start and stop events applied by applyGateEvents()
+static unsigned gateStartsApplied = 0;
+static unsigned gateStopsApplied = 0;
+
+/// @brief A Patch that has been converted to the form used by the synth
+/// engine, so that it can be applied with no further calculation
+using PreparedPatch = Voice::Settings;
+
+/// @brief Buffers for patches prepared by loadPatch() on core 0 and applied
+/// by genNextBlock() on core 1
+/// @details Patch number seq is prepared in preparedPatches[seq % 2], so
+/// core 0 can fill one buffer while core 1 may still be reading the other.
+static PreparedPatch preparedPatches[2];
+
+/// @brief Sequence number of the last patch prepared (written by core 0 only)
+static std::atomic<unsigned> seqPrepared = 0;
+
+/// @brief Sequence number of the last patch applied (written by core 1 only)
+static std::atomic<unsigned> seqApplied = 0;
+
 // Forward
-static void loadPatchDeferred(Defer::UseCritSec, unsigned index);
-static void loadPatchImpl(unsigned index);
+static void preparePatch(unsigned index, PreparedPatch* pPrepared);
+static void applyPatch(const PreparedPatch& prepared);
 static void initOperators();
 
 void init()
@@ -50,7 +76,8 @@ void init()
 
     Envelope::init();
 
-    loadPatchImpl(initialPatch);
+    preparePatch(initialPatch, &preparedPatches[0]);
+    applyPatch(preparedPatches[0]);
 
     initOperators();
 }
@@ -72,34 +99,43 @@ static void initOperators()
 
 void loadPatch(unsigned i)
 {
-    Defer::call<loadPatchDeferred>(i);
+    if (i >= Patches::numPatches) {
+        return;
+    }
+    unsigned seq = seqPrepared.load(std::memory_order_relaxed) + 1;
+    // The buffer for seq was last used for seq - 2. Core 1 may still be
+    // reading it if it hasn't yet applied seq - 2 or a later patch. This only
+    // waits if patches are loaded faster than once per block.
+    while (int(seqApplied.load(std::memory_order_acquire) - (seq - 2)) < 0) {
+        // waiting for core 1...
+    }
+    preparePatch(i, &preparedPatches[seq % 2]);
+    // Hand the prepared patch over to core 1 (see genNextBlock)
+    seqPrepared.store(seq, std::memory_order_release);
 }
 
-/// @brief Helper function called from loadPatch() via Defer
-/// @details The arguments force Defer to use a mutex because it can be a cross-core call.
+/// @brief Convert the given patch from the current patchbank into a
+/// PreparedPatch
+/// @details This does all the work of loading a patch except for copying
+/// the results into the operators. It is done by the core that calls
+/// loadPatch() so the audio core doesn't have to.
 /// @param index Patch number
-static void loadPatchDeferred(Defer::UseCritSec /*unused*/, unsigned index)
+/// @param[out] pPrepared 
+static void preparePatch(unsigned index, PreparedPatch* pPrepared)
 {
-    loadPatchImpl(index);
+    patchIndex = index;
+    const Patches::Patch& patch = Patches::getPatch(index);
+    *pPrepared = Voice::makeSettings(patch);
+    patchName = patch.name;
 }
 
-/// @brief Load the given patch from the current patchbank.
-/// @details This function sets the Synth parameters based on the given patch.
-/// @param index Patch number
-static void loadPatchImpl(unsigned index)
-{
-    if (index < Patches::numPatches) {
-        patchIndex = index;
-        const Patches::Patch& patch = Patches::getPatch(index);
-        algorithm = algorithms[patch.algorithm];
-        feedbackAmount = patch.feedbackAmount;
-        for (auto&& [op, params] : std::views::zip(operators, patch.opParams)) {
-            op.setOpParams(params);
-            op.resetWave();
-            // don't reset the envelope because that messes up live updating
-        }
-        patchName = patch.name;
-    }
+/// @brief Set the Synth parameters from a PreparedPatch
+/// @details This only copies settings, so it takes the same short time
+/// whatever the patch contains.
+/// @param prepared 
+static void applyPatch(const PreparedPatch& prepared)
+{
+    voice.setSettings(prepared);
 }
 
 unsigned getCurrentPatchNum()
@@ -114,10 +150,13 @@ const std::string_view getCurrentPatchName()
 
 void setNotePitch(phase_t pitch)
 {
-    // TODO: crit sec?
-    for (auto&& op : operators) {
-        op.setNotePitch(pitch);
+    // Only update the operators if the pitch has actually changed
+    static phase_t pitchPrev = 0;
+    if (pitch == getAndSet(pitchPrev, pitch)) {
+        return;
     }
+    // TODO: crit sec?
+    voice.setNotePitch(pitch);
 }
 
 void setTimbreMod(output_t value)
@@ -128,91 +167,87 @@ void setTimbreMod(output_t value)
 
 void gateStart()
 {
-    for (auto&& op : operators) {
-        op.gateStart();
-    }
+    gateOnLast.store(true, std::memory_order_relaxed);
+    gateStartCount.store(gateStartCount.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+}
+
+void gateStop()
+{
+    gateOnLast.store(false, std::memory_order_relaxed);
+    gateStopCount.store(gateStopCount.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+}
+
+/// @brief Start the operators' envelopes
+static void startOperators()
+{
+    voice.gateStart();
     // Notify the UI task so it can draw some graphics
     UI::UITask::onGateStart();
 }
 
-void gateStop()
+/// @brief Start the operators' release stages
+static void stopOperators()
 {
-    for (auto&& op : operators) {
-        op.gateStop();
+    voice.gateStop();
+}
+
+/// @brief Apply gate events received since the previous block
+/// @details If there has been both a start and a stop, they are applied in
+/// the order that leaves the gate in the same state as the last event.
+static void applyGateEvents()
+{
+    unsigned starts = gateStartCount.load(std::memory_order_acquire);
+    unsigned stops = gateStopCount.load(std::memory_order_acquire);
+    bool fStart = (starts != gateStartsApplied);
+    bool fStop = (stops != gateStopsApplied);
+    if (fStart && fStop && gateOnLast.load(std::memory_order_relaxed)) {
+        stopOperators();
+        startOperators();
+    } else {
+        if (fStart)
+            startOperators();
+        if (fStop)
+            stopOperators();
     }
+    gateStartsApplied = starts;
+    gateStopsApplied = stops;
 }
 
-__attribute__((__always_inline__))
-inline output_t genNextOutput()
+void genNextBlock(std::span<output_t> outputs)
 {
 #ifdef DEBUG_TEST_LFO
     // TEST: Iterate an LFO to generate timbre modulation for testing
-    setTimbreMod(opLfo.genNextOutput(0, 0));
+    for ([[maybe_unused]] auto&& output : outputs) {
+        setTimbreMod(opLfo.genNextOutput(0));
+    }
 #endif
 
-    // Check if a new patch was requested
-    Defer::checkRun<loadPatchDeferred>();
-
-    // Call genNextOutput() on each operator, handling modulation and feedback,
-    // based on the currently-selected algorithm.
-    int32_t outputTotal = 0;
-    int numOutputs = 0;
-    output_t freqModPrev = 0;
-    output_t freqModSaved = 0;
-    static int32_t feedback0 = 0;
-    static int32_t feedback1 = 0;
-    for (auto&& [op, algoOp] : std::views::zip(operators, algorithm.ops)) {
-        // Set the appropriate modulation for this operator
-        output_t freqMod;
-        switch (algoOp.mod) {
-            case UseMod::prev:
-                freqMod = freqModPrev;
-                break;
-            case UseMod::saved:
-                freqMod = freqModSaved;
-                break;
-            case UseMod::fb:
-                // Feedback is the average of the two previous values attenuated
-                // by feedbackAmount. Also arbitrarily divided by 20 to reduce
-                // distortion at high feedback amounts.
-                freqMod = output_t((int32_t(feedbackAmount) * ((feedback0 + feedback1) / 2)) / (1024*20));
-                break;
-            case UseMod::none:
-            default:
-                freqMod = 0;
-                break;
-        }
-        // Calculate this operator's output
-        output_t outputOp = op.genNextOutput(freqMod, timbreMod);
-        // Save the operator's output as either an audio output or a modulator
-        if (algoOp.isOutput) {
-            // Skip muted operators completely so that they don't kill the average.
-            if (op.getOutputLevel() != 0) {
-                outputTotal += outputOp;
-                ++numOutputs;
-            }
-        } else {
-            freqModPrev = outputOp;
-            switch (algoOp.saveMod) {
-                case SaveMod::set:
-                    freqModSaved = outputOp;
-                    break;
-                case SaveMod::add:
-                    freqModSaved += outputOp;
-                    break;
-                default:
-                case SaveMod::none:
-                    break;
-            }
-        }
-        if (algoOp.setFb) {
-            // Current and previous outputs are saved for averaged feedback
-            feedback1 = feedback0;
-            feedback0 = outputOp;
-        }
+    // Check if a new patch has been prepared by loadPatch(). When nothing is
+    // pending this is a single load and compare.
+    unsigned seq = seqPrepared.load(std::memory_order_acquire);
+    if (seq != seqApplied.load(std::memory_order_relaxed)) {
+        applyPatch(preparedPatches[seq % 2]);
+        seqApplied.store(seq, std::memory_order_release);
     }
 
-    return output_t(outputTotal / std::max(numOutputs, 1));
+    applyGateEvents();
+
+    // Calculate the outputs using the current algorithm's render kernel.
+    // timbreMod may be changed by the other core but it is only read once
+    // per block.
+    voice.genNextBlock(outputs, timbreMod);
+}
+
+#ifndef DEXY_HOST
+__attribute__((__always_inline__)) inline
+#endif
+output_t genNextOutput()
+{
+    output_t output;
+    genNextBlock(std::span(&output, 1));
+    return output;
 }
 
 } } // namespace Synth
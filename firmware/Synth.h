@@ -9,7 +9,10 @@ namespace Synth {
 void init();
 
 /// @brief Load the given patch from the current patchbank
-/// @details The patch is loaded asynchronously after this function returns.
+/// @details The patch is converted by the calling core (core 0) and handed
+/// over to the audio core, which starts using it at its next block. If this is
+/// called again before the audio core has taken the previous patch, it waits
+/// for up to one block. Must not be called by the audio core.
 /// @param i Patch index in the patchbank
 /// @see Dexy::Patches::Patch Dexy::Patches::PatchBank
 void loadPatch(unsigned i);
@@ -27,9 +30,9 @@ constexpr unsigned initialPatch = 2;
 
 /// @brief Set the pitch of the note being played
 /// @details Sets the frequency of all operators based on the given pitch, which
-/// is usually derived from a CV input.
+/// is usually derived from a CV input. Does nothing if the pitch hasn't changed.
 /// @param pitch Phase increment corresponding to the note pitch
-/// @see AdcInput::getIncrementForAdcValue() SineWave::getIncrementForMidiNote() 
+/// @see AdcMap::getIncrementForAdcValue() SineWave::getIncrementForMidiNote() 
 void setNotePitch(phase_t pitch);
 
 /// @brief Set the timbre modulation value which affects the amplitudes of operators
@@ -37,13 +40,30 @@ void setNotePitch(phase_t pitch);
 void setTimbreMod(output_t value);
 
 /// @brief Gate start signal has been received - Start playing a note
+/// @details This may be called from an interrupt handler. The note starts at
+/// the beginning of the next block generated by genNextBlock().
 void gateStart();
 
 /// @brief Gate stop signal has been received - Stop playing the note
+/// @details This may be called from an interrupt handler. The note stops at
+/// the beginning of the next block generated by genNextBlock().
 void gateStop();
 
+/// @brief Generate a block of audio output samples
+/// @details This is more efficient than calling genNextOutput() for each sample
+/// because pending patch changes, timbre modulation and the algorithm selection
+/// are only checked once per block.
+/// @param[out] outputs Buffer to fill with output samples
+void genNextBlock(std::span<output_t> outputs);
+
 /// @brief Generate the next audio output sample to be output
+/// @details This is inlined into the firmware's synth loop. The host build
+/// makes it an ordinary function so that programs using the library can call it.
 /// @return Output value
+#ifdef DEXY_HOST
+output_t genNextOutput();
+#else
 inline output_t genNextOutput();
+#endif
 
 } } // namespace Synth
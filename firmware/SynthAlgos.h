@@ -43,9 +43,43 @@ private:
         return int(countIf([](auto&& op) {return op.isOutput;}));
     }
 
+    /// @brief Find which operators each operator modulates, by following the
+    /// modulation routing
+    /// @details This gets called at compile time to initialize modTargets,
+    /// so use modTargets instead of calling this.
+    /// @return Bit mask of the operators that use each operator's output
+    constexpr std::array<unsigned, numOperators> findModTargets() const {
+        std::array<unsigned, numOperators> targets{};
+        int iPrev = -1;             // last modulator (see UseMod::prev)
+        unsigned savedSources = 0;  // modulators in the saved value (see UseMod::saved)
+        int iFbSource = int(std::ranges::find_if(ops, [](auto&& op){return op.setFb;}) - ops.begin());
+        for (int i = 0; i < int(numOperators); ++i) {
+            const AlgoOp& op = ops[i];
+            if (op.mod == UseMod::prev && iPrev >= 0) {
+                targets[iPrev] |= (1u << i);
+            } else if (op.mod == UseMod::saved) {
+                for (int j = 0; j < int(numOperators); ++j) {
+                    if (savedSources & (1u << j))
+                        targets[j] |= (1u << i);
+                }
+            } else if (op.mod == UseMod::fb && iFbSource != i && iFbSource < int(numOperators)) {
+                // Feedback from an operator to itself doesn't make it needed
+                targets[iFbSource] |= (1u << i);
+            }
+            if (!op.isOutput) {
+                iPrev = i;
+                if (op.saveMod == SaveMod::set)
+                    savedSources = (1u << i);
+                else if (op.saveMod == SaveMod::add)
+                    savedSources |= (1u << i);
+            }
+        }
+        return targets;
+    }
+
 public:
     explicit constexpr Algorithm(const AlgoOpArray& opsIn)
-        : ops(opsIn), numOutputs(countOutputs()) {}
+        : ops(opsIn), numOutputs(countOutputs()), modTargets(findModTargets()) {}
 
     /// @brief The settings for all the operators, defining the algorithm
     AlgoOpArray ops;
@@ -53,6 +87,29 @@ public:
     /// @brief How many of the operators are outputs (carriers)
     int numOutputs;
 
+    /// @brief For each operator, a bit mask of the operators that it modulates
+    std::array<unsigned, numOperators> modTargets;
+
+    /// @brief Find the operators that need to be calculated
+    /// @details An operator that is silent doesn't need to be calculated
+    /// because its output would be (practically) zero. A modulator that only
+    /// modulates operators that don't need to be calculated doesn't need to be
+    /// calculated either, whether or not it is silent itself.
+    /// @param audible Bit mask of the operators that are not silent
+    /// @return Bit mask of the operators that need to be calculated
+    constexpr unsigned findActiveOps(unsigned audible) const {
+        unsigned active = 0;
+        // Modulation goes from lower to higher operator numbers, except for
+        // feedback, so a second pass is needed for a feedback modulator.
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int i = int(numOperators) - 1; i >= 0; --i) {
+                if ((audible & (1u << i)) && (ops[i].isOutput || (modTargets[i] & active)))
+                    active |= (1u << i);
+            }
+        }
+        return active;
+    }
+
     /// @brief Is this algorithm definition valid?
     /// @return Yes or no
     constexpr bool isValid() const {
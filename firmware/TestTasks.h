@@ -193,6 +193,24 @@ public:
     static inline std::array<AdcInput::adcResult_t, numAdcValues> adcValues;
 };
 
+/// @brief Report the audio output buffer's low-water mark
+/// @details A low-water mark of 0 means that core 1 fell behind and an output
+/// sample was late.
+class OutputBufferLevel : public Tasks::Task
+{
+public:
+    unsigned intervalMicros() const override { return 1'000'000; }
+
+    void init() override {}
+
+    void execute() override
+    {
+        dprintf("output buffer low-water mark = %u/%u\n",
+            SpiDac::getBufferLowWaterMark(), SpiDac::outputBufferSize);
+        SpiDac::resetBufferLowWaterMark();
+    }
+};
+
 /// @brief Measure CPU temperature
 class MonitorTemp : public Tasks::Task
 {
@@ -45,7 +45,7 @@ template<size_t SIZE> static void showMessage(const char(&str)[SIZE]);
 static void drawNoteStart();
 static void drawNoteStop();
 static void drawNoteUpdate();
-static void onGateStartDeferred(Defer::UseCritSec /*unused*/, unsigned /*unused*/);
+static void onGateStartDeferred(Defer::LockFree /*unused*/, unsigned /*unused*/);
 static void onPatchSelectedDeferred(unsigned /*unused*/);
 static void onPatchBankUpdateDeferred(unsigned /*unused*/);
 
@@ -68,9 +68,10 @@ void UITask::onGateStart()
 }
 
 /// @brief Called from UITask::onGateStart() via Defer.
-/// @details The arguments force Defer to use a mutex because it can be a cross-core call.
+/// @details The arguments make Defer use its lock-free protocol because this is
+/// a cross-core call, made from the gate interrupt handler on core 1.
 IN_FLASH("UI")
-static void onGateStartDeferred(Defer::UseCritSec /*unused*/, unsigned /*unused*/)
+static void onGateStartDeferred(Defer::LockFree /*unused*/, unsigned /*unused*/)
 {
     drawNoteStart();
 }
@@ -123,6 +123,52 @@ consteval T mid_value()
     return static_cast<T>((std::numeric_limits<T>::min() + std::numeric_limits<T>::max()) / 2);
 }
 
+/// @brief Filter out small changes in a value, e.g. ADC input noise
+/// @details A change in the same direction as the last update is accepted
+/// immediately, so a slowly moving input is followed at full resolution. A
+/// change in the other direction is only accepted if it is larger than
+/// threshold, which stops noise from flipping the value back and forth.
+/// @tparam T A numeric type
+/// @tparam threshold Largest change in the opposite direction to ignore
+template<typename T, T threshold>
+class Hysteresis
+{
+public:
+    /// @brief Ctor
+    /// @param initial Initial value - choose one far from any input so that
+    /// the first update() always succeeds (e.g. the maximum value)
+    constexpr explicit Hysteresis(T initial = 0) : value(initial) {}
+
+    /// @brief Update the value, if the input has changed enough
+    /// @param input New input value
+    /// @return true if the value was updated
+    constexpr bool update(T input)
+    {
+        if (input > value) {
+            if (!fRising && input <= value + threshold) {
+                return false;
+            }
+            fRising = true;
+        } else if (input < value) {
+            if (fRising && input + threshold >= value) {
+                return false;
+            }
+            fRising = false;
+        } else {
+            return false;
+        }
+        value = input;
+        return true;
+    }
+
+    /// @brief Get the current value
+    constexpr T get() const { return value; }
+
+private:
+    T value;
+    bool fRising = false;   ///< Direction of the last update
+};
+
 /// @brief Convert a std::array of chars to a std::string_view
 /// @note There is a std::string_view constructor for this in C++ 23.
 /// @tparam SIZE 
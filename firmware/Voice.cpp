@@ -0,0 +1,197 @@
+namespace Dexy { namespace Synth {
+
+/// @brief Modulation values that are passed between operators while
+/// calculating one output sample
+struct ModState
+{
+    int32_t outputTotal = 0;    ///< Sum of the carrier outputs
+    int numOutputs = 0;         ///< Number of (non-muted) carriers in outputTotal
+    output_t freqModPrev = 0;   ///< Output of the previous modulator
+    output_t freqModSaved = 0;  ///< Saved modulation value (see SaveMod)
+};
+
+/// @brief Calculate one operator's output and route it according to its AlgoOp
+/// @details All of the modulation routing is resolved at compile time.
+/// @tparam algoOp The operator's settings in the current algorithm
+/// @param op The Operator
+/// @param[inout] state Modulation values being passed between operators
+/// @param fbAmount Feedback amount for the current block
+/// @param fActive If false, the operator's output is not needed so it is
+/// skipped and treated as 0
+/// @param envLevel The operator's envelope level for this sample
+/// @param[inout] feedback0 Current output of the feedback operator
+/// @param[inout] feedback1 Previous output of the feedback operator
+template<AlgoOp algoOp>
+__attribute__((__always_inline__))
+static inline void genOpOutput(Operator op, ModState& state, int32_t fbAmount,
+                               bool fActive, level_t envLevel,
+                               int32_t& feedback0, int32_t& feedback1)
+{
+    if (!fActive) {
+        op.skipNextOutput();
+        if constexpr (algoOp.isOutput) {
+            // Still count the carrier so that the output scaling doesn't
+            // change while the operator's envelope is idle.
+            state.numOutputs += (op.getOutputLevel() != 0);
+        } else {
+            state.freqModPrev = 0;
+            if constexpr (algoOp.saveMod == SaveMod::set) {
+                state.freqModSaved = 0;
+            }
+        }
+        if constexpr (algoOp.setFb) {
+            feedback1 = feedback0;
+            feedback0 = 0;
+        }
+        return;
+    }
+    // Set the appropriate modulation for this operator
+    output_t freqMod;
+    if constexpr (algoOp.mod == UseMod::prev) {
+        freqMod = state.freqModPrev;
+    } else if constexpr (algoOp.mod == UseMod::saved) {
+        freqMod = state.freqModSaved;
+    } else if constexpr (algoOp.mod == UseMod::fb) {
+        // Feedback is the average of the two previous values attenuated
+        // by feedbackAmount. Also arbitrarily divided by 20 to reduce
+        // distortion at high feedback amounts.
+        freqMod = output_t((fbAmount * ((feedback0 + feedback1) / 2)) / (1024*20));
+    } else {
+        freqMod = 0;
+    }
+    // Calculate this operator's output
+    output_t outputOp = op.genNextOutput(freqMod, envLevel);
+    // Save the operator's output as either an audio output or a modulator
+    if constexpr (algoOp.isOutput) {
+        // Skip muted operators completely so that they don't kill the average.
+        bool fAudible = (op.getOutputLevel() != 0);
+        state.outputTotal += fAudible ? outputOp : 0;
+        state.numOutputs += fAudible;
+    } else {
+        state.freqModPrev = outputOp;
+        if constexpr (algoOp.saveMod == SaveMod::set) {
+            state.freqModSaved = outputOp;
+        } else if constexpr (algoOp.saveMod == SaveMod::add) {
+            state.freqModSaved += outputOp;
+        }
+    }
+    if constexpr (algoOp.setFb) {
+        feedback1 = feedback0;
+        feedback0 = outputOp;
+    }
+}
+
+/// @brief Maximum number of samples of envelope levels that are generated at once
+constexpr unsigned envBlockSize = 16;
+
+template<unsigned iAlgo>
+void Voice::genNextBlockAlgo(Voice& voice, std::span<output_t> outputs, output_t ampMod)
+{
+    OperatorBank& operators = voice.operators;
+    const int32_t fbAmount = voice.feedbackAmount;
+    int32_t feedback0 = voice.feedback0;
+    int32_t feedback1 = voice.feedback1;
+    unsigned audibleOps = 0;
+    for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+        operators[iOp].setAmpMod(ampMod);
+        audibleOps |= unsigned(operators[iOp].isAudible()) << iOp;
+    }
+    const unsigned activeOps = algorithms[iAlgo].findActiveOps(audibleOps);
+    level_t envLevels[numOperators][envBlockSize];
+    while (!outputs.empty()) {
+        std::size_t numSamples = std::min(outputs.size(), std::size_t(envBlockSize));
+        for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+            operators[iOp].genEnvelopeBlock(std::span(envLevels[iOp], numSamples));
+        }
+        for (std::size_t i = 0; i < numSamples; ++i) {
+            ModState state;
+            [&]<std::size_t... iOp>(std::index_sequence<iOp...>) {
+                (genOpOutput<algorithms[iAlgo].ops[iOp]>(operators[iOp], state, fbAmount,
+                                                         (activeOps & (1u << iOp)) != 0,
+                                                         envLevels[iOp][i], feedback0, feedback1), ...);
+            }(std::make_index_sequence<numOperators>());
+            outputs[i] = output_t(state.outputTotal / std::max(state.numOutputs, 1));
+        }
+        outputs = outputs.subspan(numSamples);
+    }
+    voice.feedback0 = feedback0;
+    voice.feedback1 = feedback1;
+}
+
+/// @brief Table of render kernels, one for each Algorithm in algorithms[]
+constexpr std::array<Voice::RenderKernel, numAlgorithms> Voice::renderKernels =
+    []<std::size_t... iAlgo>(std::index_sequence<iAlgo...>) {
+        return std::array<RenderKernel, numAlgorithms>{ &genNextBlockAlgo<iAlgo>... };
+    }(std::make_index_sequence<numAlgorithms>());
+
+Voice::Settings Voice::makeSettings(const Patches::Patch& patch)
+{
+    Settings settings;
+    settings.renderKernel = renderKernels[patch.algorithm];
+    settings.feedbackAmount = patch.feedbackAmount;
+    settings.carrierOps = 0;
+    for (auto&& [iOp, algoOp] : std::views::enumerate(algorithms[patch.algorithm].ops)) {
+        settings.carrierOps |= unsigned(algoOp.isOutput) << iOp;
+    }
+    for (auto&& [opSettings, params] : std::views::zip(settings.opSettings, patch.opParams)) {
+        opSettings = Operator::makeSettings(params);
+    }
+    return settings;
+}
+
+void Voice::setSettings(const Settings& settings)
+{
+    renderKernel = settings.renderKernel;
+    feedbackAmount = settings.feedbackAmount;
+    carrierOps = settings.carrierOps;
+    for (auto&& [iOp, opSettings] : std::views::enumerate(settings.opSettings)) {
+        Operator op = operators[unsigned(iOp)];
+        op.setSettings(opSettings);
+        op.resetWave();
+        // don't reset the envelope because that messes up live updating
+    }
+}
+
+void Voice::setNotePitch(phase_t pitch)
+{
+    for (auto&& op : operators.all()) {
+        op.setNotePitch(pitch);
+    }
+}
+
+void Voice::gateStart()
+{
+    for (auto&& op : operators.all()) {
+        op.gateStart();
+    }
+}
+
+void Voice::gateStop()
+{
+    for (auto&& op : operators.all()) {
+        op.gateStop();
+    }
+}
+
+bool Voice::isActive()
+{
+    for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+        if ((carrierOps & (1u << iOp)) && operators[iOp].isAudible()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+level_t Voice::getLevel()
+{
+    level_t level = 0;
+    for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+        if (carrierOps & (1u << iOp)) {
+            level = std::max(level, operators[iOp].getCurrentLevel());
+        }
+    }
+    return level;
+}
+
+} } // namespace Synth
@@ -0,0 +1,276 @@
+#pragma once
+
+namespace Dexy { namespace Synth {
+
+/// @brief One voice of the synth: a set of Operators, the feedback state and
+/// the render kernel for the patch's Algorithm
+/// @details The firmware plays a single Voice (see Dexy::Synth). Programs
+/// using the host library can play several, e.g. with a VoicePool. Voices
+/// don't share any state so they can also be rendered on separate threads.
+class Voice
+{
+public:
+    /// @brief Function that calculates a block of output samples using a
+    /// particular Algorithm
+    using RenderKernel = void (*)(Voice& voice, std::span<output_t> outputs, output_t ampMod);
+
+    /// @brief Voice settings converted from a Patch, ready to be used by
+    /// setSettings()
+    struct Settings
+    {
+        RenderKernel renderKernel = &genNextBlockAlgo<0>;
+        param_t feedbackAmount = max_param_t;
+        unsigned carrierOps = 0;    ///< Bit mask of the Algorithm's carriers
+        std::array<Operator::Settings, numOperators> opSettings;
+    };
+
+    /// @brief Convert a Patch to Settings
+    /// @details This does all the table lookups and conversions, so it can be
+    /// done ahead of time on a different core than the one that calls
+    /// setSettings().
+    /// @param patch The Patch
+    static Settings makeSettings(const Patches::Patch& patch);
+
+    /// @brief Set this Voice's settings from the output of makeSettings()
+    /// @details This only copies settings, so it takes the same short time
+    /// whatever the patch contains. The operators' waveforms are reset but
+    /// their envelopes are not, because that messes up live updating.
+    /// @param settings
+    void setSettings(const Settings& settings);
+
+    /// @brief Set the pitch of the note being played by this Voice
+    /// @param pitch Phase increment corresponding to the note pitch
+    void setNotePitch(phase_t pitch);
+
+    /// @brief Start the operators' envelopes
+    void gateStart();
+
+    /// @brief Start the operators' release stages
+    void gateStop();
+
+    /// @brief Generate a block of output samples
+    /// @param[out] outputs Buffer to fill with output samples
+    /// @param ampMod Timbre modulation value for the block
+    void genNextBlock(std::span<output_t> outputs, output_t ampMod) { renderKernel(*this, outputs, ampMod); }
+
+    /// @brief Is any of the Voice's carriers making a sound?
+    /// @see Operator::isAudible()
+    bool isActive();
+
+    /// @brief Get the level of the Voice's loudest carrier, based on its
+    /// current envelope level and its output level
+    /// @details This is for choosing which voice to steal, so it doesn't
+    /// include modulation.
+    level_t getLevel();
+
+private:
+    /// @brief Render kernel for one of the algorithms
+    /// @details Generates a block of envelope levels for each operator, then
+    /// calls genNextOutput() on each operator for each sample in the block,
+    /// handling modulation and feedback, with the algorithm's modulation
+    /// routing unrolled at compile time.
+    ///
+    /// Operators that are silent, and modulators whose output only goes to
+    /// operators that are not being calculated, are skipped. That is decided
+    /// once per block (i.e. at control rate), so an operator whose envelope
+    /// starts during a block stays silent until the next block.
+    /// @tparam iAlgo Index in algorithms[]
+    /// @param voice The Voice to render
+    /// @param[out] outputs Buffer to fill with output samples
+    /// @param ampMod Timbre modulation value for the block
+    template<unsigned iAlgo>
+    static void genNextBlockAlgo(Voice& voice, std::span<output_t> outputs, output_t ampMod);
+
+    /// @brief Table of render kernels, one for each Algorithm in algorithms[]
+    static const std::array<RenderKernel, numAlgorithms> renderKernels;
+
+    OperatorBank operators;                         ///< The Operators that make the sound!
+    RenderKernel renderKernel = &genNextBlockAlgo<0>; ///< Render kernel for the current Algorithm
+    param_t feedbackAmount = max_param_t;           ///< Feedback amount to use
+    unsigned carrierOps = 0;                        ///< Bit mask of the Algorithm's carriers
+
+    /// @brief Current and previous outputs of the feedback operator
+    /// @details These are saved for averaged feedback.
+    int32_t feedback0 = 0;
+    int32_t feedback1 = 0;
+};
+
+/// @brief How VoicePool chooses a voice to steal when they are all in use
+enum class StealPolicy : char
+{
+    oldest,         ///< The voice whose note started first
+    quietest,       ///< The voice with the lowest Voice::getLevel()
+    releasedFirst   ///< The oldest voice whose gate has stopped, else the oldest voice
+};
+
+/// @brief A set of Voices that are allocated to notes as they start
+/// @details A free voice is one whose gate has stopped and whose carriers have
+/// finished their release. If there isn't a free voice when a note starts,
+/// one is stolen according to the StealPolicy.
+///
+/// The voices' outputs are added together, saturating at the limits of
+/// output_t. Every voice uses the same Voice::Settings.
+/// @tparam NUM_VOICES Number of voices
+template<unsigned NUM_VOICES>
+class VoicePool
+{
+public:
+    static_assert(NUM_VOICES >= 1, "VoicePool needs at least one voice");
+
+    /// @brief Number of voices
+    static constexpr unsigned numVoices = NUM_VOICES;
+
+    /// @brief Ctor
+    /// @param stealPolicy How to choose a voice when they are all in use
+    explicit VoicePool(StealPolicy stealPolicy = StealPolicy::releasedFirst) : policy(stealPolicy) { }
+
+    /// @brief Change the StealPolicy
+    void setStealPolicy(StealPolicy stealPolicy) { policy = stealPolicy; }
+
+    /// @brief Set every voice's settings
+    /// @param settings Settings from Voice::makeSettings()
+    void setSettings(const Voice::Settings& settings)
+    {
+        for (auto&& voice : voices) {
+            voice.setSettings(settings);
+        }
+    }
+
+    /// @brief Start a note on a free or stolen voice
+    /// @param pitch Phase increment corresponding to the note pitch
+    /// @return Index of the voice that plays the note
+    unsigned noteOn(phase_t pitch)
+    {
+        unsigned iVoice = allocate();
+        notes[iVoice] = NoteInfo{ .pitch = pitch, .serial = ++serial, .gateOn = true };
+        voices[iVoice].setNotePitch(pitch);
+        voices[iVoice].gateStart();
+        return iVoice;
+    }
+
+    /// @brief Stop the note with the given pitch, on every voice that is
+    /// playing it
+    /// @param pitch Phase increment that was passed to noteOn()
+    void noteOff(phase_t pitch)
+    {
+        for (unsigned i = 0; i < numVoices; ++i) {
+            if (notes[i].gateOn && notes[i].pitch == pitch) {
+                notes[i].gateOn = false;
+                voices[i].gateStop();
+            }
+        }
+    }
+
+    /// @brief Stop every note that is playing
+    void allNotesOff()
+    {
+        for (unsigned i = 0; i < numVoices; ++i) {
+            if (notes[i].gateOn) {
+                notes[i].gateOn = false;
+                voices[i].gateStop();
+            }
+        }
+    }
+
+    /// @brief Generate a block of output samples from all the voices that
+    /// are sounding
+    /// @param[out] outputs Buffer to fill with output samples
+    /// @param ampMod Timbre modulation value for the block
+    void genNextBlock(std::span<output_t> outputs, output_t ampMod)
+    {
+        while (!outputs.empty()) {
+            std::size_t numSamples = std::min(outputs.size(), mixBlockSize);
+            std::array<int32_t, mixBlockSize> mix = {};
+            std::array<output_t, mixBlockSize> voiceOutputs;
+            for (unsigned iVoice = 0; iVoice < numVoices; ++iVoice) {
+                if (!isSounding(iVoice)) {
+                    continue;
+                }
+                voices[iVoice].genNextBlock(std::span(voiceOutputs.data(), numSamples), ampMod);
+                for (std::size_t i = 0; i < numSamples; ++i) {
+                    mix[i] += voiceOutputs[i];
+                }
+            }
+            for (std::size_t i = 0; i < numSamples; ++i) {
+                outputs[i] = output_t(std::clamp(mix[i], int32_t(INT16_MIN), int32_t(INT16_MAX)));
+            }
+            outputs = outputs.subspan(numSamples);
+        }
+    }
+
+    /// @brief Get one of the voices
+    /// @param iVoice Voice index
+    Voice& operator[](unsigned iVoice) { return voices[iVoice]; }
+
+    /// @brief Is a voice sounding, i.e. not free?
+    /// @param iVoice Voice index
+    bool isSounding(unsigned iVoice)
+    {
+        // A voice that has never played a note may still have carriers that
+        // don't use their envelopes
+        return notes[iVoice].serial != 0 && (notes[iVoice].gateOn || voices[iVoice].isActive());
+    }
+
+private:
+    /// @brief Maximum number of samples that are mixed at once
+    static constexpr std::size_t mixBlockSize = 64;
+
+    /// @brief Choose a voice for a new note
+    /// @return Voice index
+    unsigned allocate()
+    {
+        // A free voice, if there is one
+        for (unsigned i = 0; i < numVoices; ++i) {
+            if (!isSounding(i)) {
+                return i;
+            }
+        }
+        // Otherwise steal one
+        unsigned iBest = 0;
+        for (unsigned i = 1; i < numVoices; ++i) {
+            if (isBetterToSteal(i, iBest)) {
+                iBest = i;
+            }
+        }
+        return iBest;
+    }
+
+    /// @brief Is voice i a better choice to steal than voice iBest,
+    /// according to the StealPolicy?
+    bool isBetterToSteal(unsigned i, unsigned iBest)
+    {
+        // Serial numbers are compared by difference so that wrapping around
+        // doesn't matter
+        bool fOlder = int(notes[i].serial - notes[iBest].serial) < 0;
+        switch (policy) {
+        case StealPolicy::quietest: {
+            level_t level = voices[i].getLevel();
+            level_t levelBest = voices[iBest].getLevel();
+            return level < levelBest || (level == levelBest && fOlder);
+        }
+        case StealPolicy::releasedFirst:
+            if (notes[i].gateOn != notes[iBest].gateOn) {
+                return !notes[i].gateOn;
+            }
+            return fOlder;
+        case StealPolicy::oldest:
+        default:
+            return fOlder;
+        }
+    }
+
+    /// @brief Information about the note that a voice is playing
+    struct NoteInfo
+    {
+        phase_t pitch = 0;      ///< Note pitch passed to noteOn()
+        unsigned serial = 0;    ///< Note number, counting from 1, to find the oldest
+        bool gateOn = false;    ///< Has the note not been stopped yet?
+    };
+
+    std::array<Voice, NUM_VOICES> voices;
+    std::array<NoteInfo, NUM_VOICES> notes = {};
+    unsigned serial = 0;        ///< Serial number of the last note started
+    StealPolicy policy;
+};
+
+} } // namespace Synth
@@ -2,13 +2,148 @@
 
 namespace Dexy {
 
+/// @brief Interpolation policies for WaveTable
+/// @details Each policy has a static function that calculates a value between
+/// two adjacent table entries:
+/// @code
+/// VALUE_T interpolate(VALUE_T entry0, VALUE_T entry1, phase_t fraction)
+/// @endcode
+/// where fraction is the low cbitsLookupFraction bits of the table position.
+///
+/// A policy may also provide the whole table lookup, and an initialization
+/// function that is called by WaveTable::init():
+/// @code
+/// template<typename VALUE_T> VALUE_T lookup(const VALUE_T* table, phase_t phase)
+/// template<typename VALUE_T> void init()
+/// @endcode
+namespace Interpolate {
+
+/// @brief No interpolation - use the nearest table entry
+struct Nearest
+{
+    template<typename VALUE_T>
+    static VALUE_T interpolate(VALUE_T entry0, VALUE_T entry1, phase_t fraction)
+    {
+        return (fraction & bitmask(cbitsLookupFraction - 1)) ? entry1 : entry0;
+    }
+};
+
+/// @brief Interpolate to the nearest 1/8 between entries by averaging
+/// three times
+/// @details Only adds and shifts, but three data-dependent selects.
+struct Average3
+{
+    template<typename VALUE_T>
+    static VALUE_T interpolate(VALUE_T entry0, VALUE_T entry1, phase_t fraction)
+    {
+        VALUE_T value = entry0;
+        value = VALUE_T((value + ((fraction & bitmask(cbitsLookupFraction - 3)) ? entry1 : entry0)) / 2);
+        value = VALUE_T((value + ((fraction & bitmask(cbitsLookupFraction - 2)) ? entry1 : entry0)) / 2);
+        value = VALUE_T((value + ((fraction & bitmask(cbitsLookupFraction - 1)) ? entry1 : entry0)) / 2);
+        return value;
+    }
+};
+
+/// @brief Linear interpolation using all the fraction bits
+/// @details One 32-bit multiply, which is a single cycle on the RP2040.
+/// A 16-bit difference times a 15-bit fraction fits in an int32_t.
+struct Linear
+{
+    template<typename VALUE_T>
+    static VALUE_T interpolate(VALUE_T entry0, VALUE_T entry1, phase_t fraction)
+    {
+        static_assert(sizeof(VALUE_T) == 2 && cbitsLookupFraction <= 15);
+        int32_t diff = int32_t(entry1) - int32_t(entry0);
+        return VALUE_T(entry0 + ((diff * int32_t(fraction)) >> cbitsLookupFraction));
+    }
+};
+
+/// @brief Linear interpolation using the top 8 fraction bits
+/// @details This is the software equivalent of Hardware.
+struct Blend8
+{
+    /// @brief Number of fraction bits used
+    static constexpr unsigned cbitsBlend = 8;
+
+    template<typename VALUE_T>
+    static VALUE_T interpolate(VALUE_T entry0, VALUE_T entry1, phase_t fraction)
+    {
+        static_assert(sizeof(VALUE_T) == 2);
+        int32_t diff = int32_t(entry1) - int32_t(entry0);
+        int32_t alpha = int32_t(fraction >> (cbitsLookupFraction - cbitsBlend));
+        return VALUE_T(entry0 + ((diff * alpha) >> cbitsBlend));
+    }
+};
+
+/// @brief Table lookup and linear interpolation using the RP2040 hardware
+/// interpolators
+/// @details interp1 lane 0 calculates the table offset from the phase, and
+/// interp0 is in blend mode, with lane 1 taking its fraction from the phase.
+/// The result is the same as Blend8, bit for bit.
+///
+/// Each core has its own interpolators, so init() must be called on the core
+/// that does the lookups, and they must not be used by interrupt handlers on
+/// that core (the state isn't saved). Only one VALUE_T size can be used at a
+/// time because init() sets up the offset calculation for it.
+///
+/// On the host the interpolators are modelled in software (host/InterpModel.h).
+/// interp1's base is 0 and the table address is added in software, because
+/// host pointers are 64 bits.
+struct Hardware
+{
+    template<typename VALUE_T>
+    static void init()
+    {
+        constexpr unsigned cbitsSize = bits_in_num(sizeof(VALUE_T)) - 1;
+        static_assert(sizeof(VALUE_T) == 1u << cbitsSize);
+        // interp1 lane 0: byte offset of the table entry
+        interp_config config = interp_default_config();
+        interp_config_set_shift(&config, cbitsLookupFraction - cbitsSize);
+        interp_config_set_mask(&config, cbitsSize, cbitsSize + cbitsLookupIndex - 1);
+        interp_set_config(interp1, 0, &config);
+        interp_set_base(interp1, 0, 0);
+        // interp0 lane 0: blend mode
+        config = interp_default_config();
+        interp_config_set_blend(&config, true);
+        interp_set_config(interp0, 0, &config);
+        // interp0 lane 1: blend fraction, signed blend if VALUE_T is signed
+        config = interp_default_config();
+        interp_config_set_shift(&config, cbitsLookupFraction - Blend8::cbitsBlend);
+        interp_config_set_mask(&config, 0, Blend8::cbitsBlend - 1);
+        interp_config_set_signed(&config, std::is_signed_v<VALUE_T>);
+        interp_set_config(interp0, 1, &config);
+    }
+
+    template<typename VALUE_T>
+    static VALUE_T interpolate(VALUE_T entry0, VALUE_T entry1, phase_t fraction)
+    {
+        return Blend8::interpolate(entry0, entry1, fraction);
+    }
+
+    template<typename VALUE_T>
+    static VALUE_T lookup(const VALUE_T* table, phase_t phase)
+    {
+        interp_set_accumulator(interp1, 0, phase);
+        interp_set_accumulator(interp0, 1, phase);
+        const VALUE_T* entry = reinterpret_cast<const VALUE_T*>(
+            reinterpret_cast<uintptr_t>(table) + interp_peek_lane_result(interp1, 0));
+        interp_set_base(interp0, 0, uint32_t(int32_t(entry[0])));
+        interp_set_base(interp0, 1, uint32_t(int32_t(entry[1])));
+        return VALUE_T(interp_peek_lane_result(interp0, 1));
+    }
+};
+
+} // namespace Interpolate
+
 /// @brief Table lookup and interpolation for waveforms and envelopes
 /// @details Multiple WaveTable classes can be defined, each using a different lookup table.
 /// The lookup table is defined by a static DataTable object.
 /// @tparam VALUE_T Type of values in the wavetable
 /// @tparam NUM_VALUES Number of values in the wavetable
 /// @tparam FUNC_CALC1 Function/lambda to calculate one table entry
-template<typename VALUE_T, std::size_t NUM_VALUES, VALUE_T FUNC_CALC1(std::size_t index, std::size_t numValues)>
+/// @tparam INTERPOLATE Interpolation policy - one of the Interpolate classes
+template<typename VALUE_T, std::size_t NUM_VALUES, VALUE_T FUNC_CALC1(std::size_t index, std::size_t numValues),
+         typename INTERPOLATE = Interpolate::Average3>
 class WaveTable
 {
 public:
@@ -26,8 +161,24 @@ public:
     /// @param increment phase_t value added to pCurrent to get the next position
     /// @param modulation Phase modulation value
     /// @return Interpolated wavetable value
-    static VALUE_T lookupInterpolate(phase_t* pCurrent, phase_t increment, modulation_t modulation);
- 
+    static VALUE_T lookupInterpolate(phase_t* pCurrent, phase_t increment, modulation_t modulation)
+    {
+        phase_t phase = *pCurrent + modulation;
+        VALUE_T value;
+        if constexpr (requires { INTERPOLATE::lookup(lookupTable.getArrayConst(), phase); }) {
+            value = INTERPOLATE::lookup(lookupTable.getArrayConst(), phase);
+        } else {
+            // Find the nearest pair of values in the lookup table
+            unsigned index = ((phase >> cbitsLookupFraction) % (sizeLookupTable-1));
+            // Interpolate between the two table values
+            value = INTERPOLATE::interpolate(lookupTable[index], lookupTable[index+1],
+                                             phase & mask_low_bits(cbitsLookupFraction));
+        }
+        // Increment to the next sample
+        *pCurrent += increment;
+        return value;
+    }
+
     /// @brief Return the interpolated value at the given position in the wavetable
     /// (without modulation)
     /// @details pCurrent is updated to the next position by adding increment, which
@@ -47,4 +198,97 @@ private:
     static constexpr DataTable<VALUE_T, NUM_VALUES, FUNC_CALC1> lookupTable = DataTable<VALUE_T, NUM_VALUES, FUNC_CALC1>();
 };
 
+/// @brief Table lookup and interpolation for a waveform with quarter-wave
+/// symmetry, e.g. a sine wave
+/// @details Only the first quarter of the cycle is stored. The other three
+/// quarters are made by mirroring the position and/or negating the value, so
+/// the table has 4 times the resolution of a WaveTable of the same size.
+/// The phase_t format is the same as WaveTable's: the top 2 of the cbitsPhase
+/// significant bits select the quarter, and the bits below the table index are
+/// the interpolation fraction.
+///
+/// The mirroring and negation are done without branches. In the mirrored
+/// quarters the table is read backwards from the end, and the interpolation
+/// still goes from the earlier to the later table entry in time, so the
+/// interpolation error is the same in every quarter. (Mirroring the position
+/// instead makes the error of a truncating interpolation policy alternate
+/// between a lag and a lead, which adds harmonics.) Likewise the entries are
+/// negated before interpolating, not the result, so the rounding is the same
+/// as for a full table. The result is the same as a WaveTable of the whole
+/// cycle at the same resolution.
+/// @tparam VALUE_T Type of values in the wavetable - must be signed
+/// @tparam CBITS_INDEX Number of index bits for one quarter of the cycle;
+/// the table has 2^CBITS_INDEX + 1 entries
+/// @tparam FUNC_CALC1 Function/lambda to calculate one table entry for the
+/// first quarter of the cycle, including the end point
+/// @tparam INTERPOLATE Interpolation policy - one of the Interpolate classes
+/// (only its interpolate() function is used)
+template<typename VALUE_T, unsigned CBITS_INDEX, VALUE_T FUNC_CALC1(std::size_t index, std::size_t numValues),
+         typename INTERPOLATE = Interpolate::Average3>
+class QuarterWaveTable
+{
+public:
+    /// @brief Number of entries in the table
+    static constexpr std::size_t numValues = (1u << CBITS_INDEX) + 1;
+
+    /// @brief Initialize the QuarterWaveTable class
+    /// @details This does not populate the wavetable data - that is done at compile time.
+    static void init();
+
+    /// @brief Return the interpolated value at the given position in the
+    /// waveform, which is modified by a modulation value
+    /// @details Same as WaveTable::lookupInterpolate().
+    /// @param[inout] pCurrent Waveform position as a fixed-point phase_t value
+    /// @param increment phase_t value added to pCurrent to get the next position
+    /// @param modulation Phase modulation value
+    /// @return Interpolated waveform value
+    static VALUE_T lookupInterpolate(phase_t* pCurrent, phase_t increment, modulation_t modulation)
+    {
+        phase_t phase = *pCurrent + modulation;
+        unsigned index = (phase >> cbitsFraction) & mask_low_bits(CBITS_INDEX);
+        // In the 2nd and 4th quarters read the table backwards from the end:
+        // index0 = numValues-1 - index = ~index + numValues, and step = -1
+        int mirror = -int((phase >> cbitsQuarter) & 1);
+        unsigned index0 = (index ^ unsigned(mirror)) + (unsigned(mirror) & numValues);
+        unsigned index1 = index0 + unsigned(1 | mirror);
+        phase_t fraction = phase & mask_low_bits(cbitsFraction);
+        if constexpr (cbitsFraction < cbitsLookupFraction) {
+            fraction <<= cbitsLookupFraction - cbitsFraction;
+        } else {
+            fraction >>= cbitsFraction - cbitsLookupFraction;
+        }
+        // Negate the entries in the 3rd and 4th quarters
+        int32_t negate = -int32_t((phase >> (cbitsQuarter + 1)) & 1);
+        VALUE_T entry0 = VALUE_T((lookupTable[index0] ^ negate) - negate);
+        VALUE_T entry1 = VALUE_T((lookupTable[index1] ^ negate) - negate);
+        // Increment to the next sample
+        *pCurrent += increment;
+        return INTERPOLATE::interpolate(entry0, entry1, fraction);
+    }
+
+    /// @brief Return the interpolated value at the given position in the
+    /// waveform (without modulation)
+    /// @details Same as WaveTable::lookupInterpolate().
+    /// @param[inout] pCurrent Waveform position as a fixed-point phase_t value
+    /// @param increment phase_t value added to pCurrent to get the next position
+    /// @return Interpolated waveform value
+    static VALUE_T lookupInterpolate(phase_t* pCurrent, phase_t increment)
+    {
+        return lookupInterpolate(pCurrent, increment, 0);
+    }
+
+private:
+    /// @brief Number of phase bits in one quarter of the cycle
+    static constexpr unsigned cbitsQuarter = cbitsPhase - 2;
+
+    /// @brief Number of interpolation fraction bits
+    static constexpr unsigned cbitsFraction = cbitsQuarter - CBITS_INDEX;
+
+    static_assert(std::is_signed_v<VALUE_T>, "QuarterWaveTable value type must be signed");
+    static_assert(CBITS_INDEX < cbitsQuarter, "QuarterWaveTable has too many index bits");
+
+    /// @brief Pre-calculated wavetable data for the first quarter of the cycle
+    static constexpr DataTable<VALUE_T, numValues, FUNC_CALC1> lookupTable = DataTable<VALUE_T, numValues, FUNC_CALC1>();
+};
+
 }
@@ -0,0 +1,23 @@
+// DexyCore - Host (Linux) build of the synth core as a library
+
+#include "DexyCore.h"
+
+// .cpp files are all included here and compiled in one unit, the same way as
+// main.cpp does for the firmware.
+#include "Error.cpp"
+#include "HostFlash.cpp"
+#include "Patches.cpp"
+#include "WaveTable.cpp"
+#include "SineWave.cpp"
+#include "AdcMap.cpp"
+#include "Envelope.cpp"
+#include "Operator.cpp"
+#include "Voice.cpp"
+#include "Synth.cpp"
+
+namespace Dexy { namespace Patches {
+
+// For host programs that load patch banks from files
+template bool loadCurrentPatchBank(const std::span<const char>& storage);
+
+} } // namespace Patches
@@ -0,0 +1,75 @@
+#pragma once
+
+// DexyCore - Main header file for the host (Linux) build of the synth core
+//
+// This is the host equivalent of Dexy.h. It includes only the modules that make
+// up the synth engine, with PicoShim.h standing in for the Pi Pico SDK, so the
+// real fixed-point engine can be built, tested and benchmarked without hardware.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <string> // only for ShowDecl.h
+#include <string_view>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <stdio.h>
+
+using namespace std::literals;
+
+#include "RangesCompat.h"
+#include "PicoShim.h"
+#include "InterpModel.h"
+
+#include "Debug.h"
+
+#include "Defs.h"
+#include "Utils.h"
+#include "Error.h"
+#include "Flash.h"
+#include "Serialize.h"
+
+#include "Patches.h"
+#include "PatchData.h"
+#include "PatchChanges.h"
+
+#include "CritSec.h"
+#include "Defer.h"
+#include "RingBuffer.h"
+#include "DacStream.h"
+#include "DataTable.h"
+#include "WaveTable.h"
+#include "SineWave.h"
+#include "AdcMap.h"
+#include "Envelope.h"
+#include "Operator.h"
+#include "SynthAlgos.h"
+#include "Voice.h"
+
+namespace Dexy {
+
+/// @brief Host stand-in for the user interface, which the synth core notifies
+/// about gate events
+namespace UI {
+struct UITask
+{
+    static void onGateStart() { }
+};
+} // namespace UI
+
+} // namespace Dexy
+
+#include "Synth.h"
+#include "PitchCv.h"
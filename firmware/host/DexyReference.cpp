@@ -0,0 +1,6 @@
+// DexyReference - Host-only reference implementation of the synth voice as a
+// library
+
+#include "DexyReference.h"
+
+#include "ReferenceVoice.cpp"
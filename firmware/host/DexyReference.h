@@ -0,0 +1,12 @@
+#pragma once
+
+// DexyReference - Main header file for the host-only reference implementation
+// of the synth voice (see ReferenceVoice.h)
+//
+// This is kept out of DexyCore so that the synth core doesn't depend on it.
+
+#include "DexyCore.h"
+
+#include <numbers>
+
+#include "ReferenceVoice.h"
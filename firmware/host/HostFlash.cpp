@@ -0,0 +1,12 @@
+namespace Dexy { namespace Flash {
+
+/// @details On the host, "flash memory" is ordinary memory so the object is
+/// simply copied.
+template<typename T>
+__attribute__((noinline))
+void copyToFlash(const T& objFrom, Wrapper<T>* pobjTo)
+{
+    pobjTo->obj = objFrom;
+}
+
+} } // namespace Flash
@@ -0,0 +1,215 @@
+// InterpModel - Host software model of the RP2040 hardware interpolators
+//
+// This provides the subset of the Pico SDK's hardware/interp.h API that is
+// used by the synth core, operating on a model of the interpolator registers
+// so that code using the interpolators can be run and checked on the host.
+// The behaviour follows the RP2040 datasheet, section 2.3.1.6.
+
+#pragma once
+
+/// @brief Interpolator registers
+/// @details Unlike the real hardware, reading a result doesn't have side
+/// effects; the pop functions do the write-back explicitly.
+struct interp_hw_t
+{
+    uint32_t accum[2];
+    uint32_t base[3];
+    uint32_t ctrl[2];
+};
+
+/// @brief Model of the interpolators - the host has only one "core"
+inline interp_hw_t interpModel[2] = {};
+
+#define interp0 (&interpModel[0])
+#define interp1 (&interpModel[1])
+
+/// @brief Interpolator lane configuration (a CTRL_LANEx register value)
+typedef struct { uint32_t ctrl; } interp_config;
+
+/// @brief CTRL_LANEx register fields (same as SIO_INTERPx_CTRL_LANEx_*)
+namespace InterpCtrl {
+constexpr unsigned shiftLsb = 0;        ///< SHIFT: 5 bits
+constexpr unsigned maskLsbLsb = 5;      ///< MASK_LSB: 5 bits
+constexpr unsigned maskMsbLsb = 10;     ///< MASK_MSB: 5 bits
+constexpr unsigned bitSigned = 15;      ///< SIGNED
+constexpr unsigned bitCrossInput = 16;  ///< CROSS_INPUT
+constexpr unsigned bitCrossResult = 17; ///< CROSS_RESULT
+constexpr unsigned bitAddRaw = 18;      ///< ADD_RAW
+constexpr unsigned bitBlend = 21;       ///< BLEND (interp0 lane 0 only)
+
+/// @brief Get a field from a CTRL value
+constexpr uint32_t field(uint32_t ctrl, unsigned lsb, unsigned numBits)
+{
+    return (ctrl >> lsb) & ((1u << numBits) - 1);
+}
+
+/// @brief Set a field in a CTRL value
+constexpr uint32_t setField(uint32_t ctrl, unsigned lsb, unsigned numBits, uint32_t value)
+{
+    uint32_t mask = ((1u << numBits) - 1) << lsb;
+    return (ctrl & ~mask) | ((value << lsb) & mask);
+}
+} // namespace InterpCtrl
+
+inline interp_config interp_default_config()
+{
+    interp_config c = { 0 };
+    c.ctrl = InterpCtrl::setField(c.ctrl, InterpCtrl::maskMsbLsb, 5, 31);
+    return c;
+}
+
+inline void interp_config_set_shift(interp_config* c, uint shift)
+{
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::shiftLsb, 5, shift);
+}
+
+inline void interp_config_set_mask(interp_config* c, uint mask_lsb, uint mask_msb)
+{
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::maskLsbLsb, 5, mask_lsb);
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::maskMsbLsb, 5, mask_msb);
+}
+
+inline void interp_config_set_signed(interp_config* c, bool _signed)
+{
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::bitSigned, 1, _signed);
+}
+
+inline void interp_config_set_cross_input(interp_config* c, bool cross_input)
+{
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::bitCrossInput, 1, cross_input);
+}
+
+inline void interp_config_set_cross_result(interp_config* c, bool cross_result)
+{
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::bitCrossResult, 1, cross_result);
+}
+
+inline void interp_config_set_add_raw(interp_config* c, bool add_raw)
+{
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::bitAddRaw, 1, add_raw);
+}
+
+inline void interp_config_set_blend(interp_config* c, bool blend)
+{
+    c->ctrl = InterpCtrl::setField(c->ctrl, InterpCtrl::bitBlend, 1, blend);
+}
+
+inline void interp_set_config(interp_hw_t* interp, uint lane, interp_config* config)
+{
+    interp->ctrl[lane] = config->ctrl;
+}
+
+inline void interp_set_base(interp_hw_t* interp, uint lane, uint32_t val) { interp->base[lane] = val; }
+inline uint32_t interp_get_base(interp_hw_t* interp, uint lane) { return interp->base[lane]; }
+inline void interp_set_accumulator(interp_hw_t* interp, uint lane, uint32_t val) { interp->accum[lane] = val; }
+inline uint32_t interp_get_accumulator(interp_hw_t* interp, uint lane) { return interp->accum[lane]; }
+
+namespace InterpModel {
+
+/// @brief A lane's shift-and-mask value
+/// @details The input is the lane's own accumulator, or the other lane's with
+/// CROSS_INPUT. It is shifted right, masked and, with SIGNED, sign-extended
+/// from the mask's MSB.
+inline uint32_t shiftMask(const interp_hw_t* interp, uint lane)
+{
+    using namespace InterpCtrl;
+    uint32_t ctrl = interp->ctrl[lane];
+    uint32_t input = interp->accum[field(ctrl, bitCrossInput, 1) ? 1 - lane : lane];
+    unsigned maskLsb = field(ctrl, maskLsbLsb, 5);
+    unsigned maskMsb = field(ctrl, maskMsbLsb, 5);
+    uint32_t mask = (maskMsb == 31 ? ~0u : (2u << maskMsb) - 1) & ~((1u << maskLsb) - 1);
+    uint32_t value = (input >> field(ctrl, shiftLsb, 5)) & mask;
+    if (field(ctrl, bitSigned, 1) && maskMsb < 31 && (value & (1u << maskMsb))) {
+        value |= ~((2u << maskMsb) - 1);
+    }
+    return value;
+}
+
+/// @brief A lane's input to its adder: the shift-and-mask value, or the raw
+/// input with ADD_RAW
+inline uint32_t addend(const interp_hw_t* interp, uint lane)
+{
+    using namespace InterpCtrl;
+    uint32_t ctrl = interp->ctrl[lane];
+    if (field(ctrl, bitAddRaw, 1)) {
+        return interp->accum[field(ctrl, bitCrossInput, 1) ? 1 - lane : lane];
+    }
+    return shiftMask(interp, lane);
+}
+
+/// @brief Is interp0 in blend mode?
+inline bool isBlend(const interp_hw_t* interp)
+{
+    return interp == interp0 && InterpCtrl::field(interp->ctrl[0], InterpCtrl::bitBlend, 1);
+}
+
+/// @brief A lane's result (LANEx_RESULT / PEEK_LANEx)
+/// @details In blend mode lane 1 interpolates between BASE0 and BASE1 using
+/// the 8 LSBs of lane 1's shift-and-mask value as the fraction:
+/// BASE0 + (((BASE1 - BASE0) * alpha) >> 8), with signed values if lane 1
+/// is SIGNED.
+inline uint32_t laneResult(const interp_hw_t* interp, uint lane)
+{
+    if (lane == 1 && isBlend(interp)) {
+        int64_t alpha = shiftMask(interp, 1) & 0xFF;
+        int64_t base0, base1;
+        if (InterpCtrl::field(interp->ctrl[1], InterpCtrl::bitSigned, 1)) {
+            base0 = int32_t(interp->base[0]);
+            base1 = int32_t(interp->base[1]);
+        } else {
+            base0 = interp->base[0];
+            base1 = interp->base[1];
+        }
+        return uint32_t(base0 + (((base1 - base0) * alpha) >> 8));
+    }
+    return interp->base[lane] + addend(interp, lane);
+}
+
+/// @brief The full result (PEEK_FULL): BASE2 plus both lanes, or only lane 0
+/// in blend mode
+inline uint32_t fullResult(const interp_hw_t* interp)
+{
+    uint32_t result = interp->base[2] + addend(interp, 0);
+    if (!isBlend(interp)) {
+        result += addend(interp, 1);
+    }
+    return result;
+}
+
+/// @brief Write the lane results back to the accumulators, as a pop does
+/// @details With CROSS_RESULT a lane's accumulator gets the other lane's result.
+inline void writeBack(interp_hw_t* interp)
+{
+    uint32_t result0 = laneResult(interp, 0);
+    uint32_t result1 = laneResult(interp, 1);
+    bool fCross0 = InterpCtrl::field(interp->ctrl[0], InterpCtrl::bitCrossResult, 1);
+    bool fCross1 = InterpCtrl::field(interp->ctrl[1], InterpCtrl::bitCrossResult, 1);
+    interp->accum[0] = fCross0 ? result1 : result0;
+    interp->accum[1] = fCross1 ? result0 : result1;
+}
+
+} // namespace InterpModel
+
+inline uint32_t interp_peek_lane_result(interp_hw_t* interp, uint lane)
+{
+    return InterpModel::laneResult(interp, lane);
+}
+
+inline uint32_t interp_pop_lane_result(interp_hw_t* interp, uint lane)
+{
+    uint32_t result = InterpModel::laneResult(interp, lane);
+    InterpModel::writeBack(interp);
+    return result;
+}
+
+inline uint32_t interp_peek_full_result(interp_hw_t* interp)
+{
+    return InterpModel::fullResult(interp);
+}
+
+inline uint32_t interp_pop_full_result(interp_hw_t* interp)
+{
+    uint32_t result = InterpModel::fullResult(interp);
+    InterpModel::writeBack(interp);
+    return result;
+}
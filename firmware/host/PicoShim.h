@@ -0,0 +1,66 @@
+// PicoShim - Host stand-ins for the parts of the Raspberry Pi Pico SDK that
+// are used by the synth core
+
+#pragma once
+
+/// @brief Pico SDK shorthand for unsigned int
+using uint = unsigned int;
+
+// Memory placement
+
+/// @brief There is no flash vs. RAM distinction on the host, so IN_FLASH
+/// does nothing.
+/// @see CompileDefs.h
+#define __in_flash(group)
+#define IN_FLASH(group) __in_flash(group)
+
+// Time
+
+/// @brief Same definition as the Pico SDK: an opaque struct in Debug builds
+/// and a plain integer in Release builds
+/// @see Dexy::to_us_since_boot_constexpr()
+#ifdef NDEBUG
+typedef uint64_t absolute_time_t;
+#else
+typedef struct { uint64_t _private_us_since_boot; } absolute_time_t;
+#endif
+
+/// @brief Microseconds since "boot" (since the host program started)
+inline uint64_t time_us_64()
+{
+    static const auto tStart = std::chrono::steady_clock::now();
+    auto tNow = std::chrono::steady_clock::now();
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(tNow - tStart).count());
+}
+
+inline absolute_time_t get_absolute_time()
+{
+    absolute_time_t t;
+#ifdef NDEBUG
+    t = time_us_64();
+#else
+    t._private_us_since_boot = time_us_64();
+#endif
+    return t;
+}
+
+// Critical sections
+// critical_section_t is a spinlock plus disabled interrupts on the RP2040.
+// On the host a std::mutex does the same job for Dexy::CritSec.
+
+struct critical_section_t { std::mutex mutex; };
+
+inline void critical_section_init(critical_section_t* /*unused*/) { }
+inline void critical_section_deinit(critical_section_t* /*unused*/) { }
+inline void critical_section_enter_blocking(critical_section_t* cs) { cs->mutex.lock(); }
+inline void critical_section_exit(critical_section_t* cs) { cs->mutex.unlock(); }
+
+// Cores
+
+/// @brief There is only one "core" on the host
+inline uint get_core_num() { return 0; }
+
+// Flash memory
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
@@ -0,0 +1,100 @@
+// RangesCompat - Minimal std::views::enumerate and std::views::zip for host
+// compilers whose standard library doesn't have them yet (e.g. gcc 12)
+
+#pragma once
+
+#if !defined(__cpp_lib_ranges_enumerate) || !defined(__cpp_lib_ranges_zip)
+
+namespace Dexy { namespace RangesCompat {
+
+/// @brief View of a sized random-access range that yields (index, element) pairs
+/// @details Only covers what the firmware uses: structured bindings in a
+/// range-for, including in consteval functions.
+template<typename R>
+class EnumerateView
+{
+public:
+    constexpr explicit EnumerateView(R& r) : range(r) { }
+
+    class iterator
+    {
+    public:
+        constexpr iterator(R* pr, std::ptrdiff_t i) : prange(pr), index(i) { }
+        constexpr auto operator*() const
+        {
+            using ref_t = decltype(*std::ranges::begin(*prange));
+            return std::tuple<std::ptrdiff_t, ref_t>(index, std::ranges::begin(*prange)[index]);
+        }
+        constexpr iterator& operator++() { ++index; return *this; }
+        constexpr bool operator==(const iterator& other) const { return index == other.index; }
+    private:
+        R* prange;
+        std::ptrdiff_t index;
+    };
+
+    constexpr iterator begin() const { return iterator(&range, 0); }
+    constexpr iterator end() const { return iterator(&range, std::ptrdiff_t(std::ranges::size(range))); }
+
+private:
+    R& range;
+};
+
+/// @brief View of two sized random-access ranges that yields pairs of elements
+/// @details Stops at the end of the shorter range, like std::views::zip.
+template<typename R1, typename R2>
+class ZipView
+{
+public:
+    constexpr ZipView(R1& r1, R2& r2) : range1(r1), range2(r2) { }
+
+    class iterator
+    {
+    public:
+        constexpr iterator(R1* pr1, R2* pr2, std::size_t i) : prange1(pr1), prange2(pr2), index(i) { }
+        constexpr auto operator*() const
+        {
+            using ref1_t = decltype(*std::ranges::begin(*prange1));
+            using ref2_t = decltype(*std::ranges::begin(*prange2));
+            return std::tuple<ref1_t, ref2_t>(std::ranges::begin(*prange1)[index],
+                                              std::ranges::begin(*prange2)[index]);
+        }
+        constexpr iterator& operator++() { ++index; return *this; }
+        constexpr bool operator==(const iterator& other) const { return index == other.index; }
+    private:
+        R1* prange1;
+        R2* prange2;
+        std::size_t index;
+    };
+
+    constexpr iterator begin() const { return iterator(&range1, &range2, 0); }
+    constexpr iterator end() const
+    {
+        return iterator(&range1, &range2,
+            std::min(std::size_t(std::ranges::size(range1)), std::size_t(std::ranges::size(range2))));
+    }
+
+private:
+    R1& range1;
+    R2& range2;
+};
+
+} } // namespace RangesCompat
+
+namespace std { namespace ranges { namespace views {
+
+#ifndef __cpp_lib_ranges_enumerate
+template<typename R>
+constexpr auto enumerate(R&& r) { return Dexy::RangesCompat::EnumerateView<std::remove_reference_t<R>>(r); }
+#endif
+
+#ifndef __cpp_lib_ranges_zip
+template<typename R1, typename R2>
+constexpr auto zip(R1&& r1, R2&& r2)
+{
+    return Dexy::RangesCompat::ZipView<std::remove_reference_t<R1>, std::remove_reference_t<R2>>(r1, r2);
+}
+#endif
+
+} } } // namespace std::ranges::views
+
+#endif
@@ -0,0 +1,268 @@
+namespace Dexy { namespace Reference {
+
+/// @brief End of every envelope stage's progress (Envelope's max_progress_t)
+static constexpr double maxProgress = double((1u << cbitsPhase) - 1);
+
+/// @brief Progress per entry of the envelope lookup tables
+static constexpr double progressPerEntry = double(1u << cbitsLookupFraction);
+
+/// @brief Number of intervals in the envelope lookup tables
+static constexpr double numEntries = double(sizeLookupTable - 1);
+
+double Envelope::rateFromParam(param_t param)
+{
+    if (param >= max_param_t) {
+        // As short as possible: the stage ends on the next sample
+        return double(1u << cbitsPhase);
+    }
+    return std::exp(param * 0.01) * 12.0243 - 11;
+}
+
+double Envelope::attackLevel(double progress)
+{
+    double x = progress / progressPerEntry;
+    return std::min(x * x * 0.2499962, double(max_level_t));
+}
+
+double Envelope::attackProgress(double level)
+{
+    return std::sqrt(level / 0.2499962) * progressPerEntry;
+}
+
+double Envelope::decayLevel(double progress)
+{
+    double x = progress / progressPerEntry;
+    if (x >= numEntries) {
+        return 0;
+    }
+    return std::clamp(std::exp((numEntries - x) * 0.01) * 393.996 - 394, 0.0, double(max_level_t));
+}
+
+double Envelope::decayProgress(double level)
+{
+    return std::max(numEntries - std::log((level + 394) / 393.996) * 100, 0.0) * progressPerEntry;
+}
+
+void Envelope::setParams(const Patches::EnvParams& params)
+{
+    delay = rateFromParam(param_t(max_param_t - params.delay));
+    attack = rateFromParam(params.attack) * 3 / 2;
+    decay = rateFromParam(params.decay);
+    sustain = Operator::levelFromParam(params.sustain);
+    release = rateFromParam(params.release);
+    loop = params.loop;
+}
+
+void Envelope::gateStart()
+{
+    gateOn = true;
+    setStage(Stage::Delay);
+}
+
+void Envelope::gateStop()
+{
+    if (getAndSet(gateOn, false)) {
+        setStage(Stage::Release);
+    }
+}
+
+void Envelope::setStage(Stage stageNew)
+{
+    stage = stageNew;
+    switch (stage) {
+    case Stage::Idle:
+        progress = 0;
+        increment = 0;
+        level = 0;
+        break;
+    case Stage::Delay:
+        // The release curve carries on from the current level during the delay
+        delayProgress = 0;
+        progress = decayProgress(level);
+        increment = delay;
+        break;
+    case Stage::Attack:
+        progress = attackProgress(level);
+        increment = attack;
+        break;
+    case Stage::Decay:
+        progress = decayProgress(level - sustain);
+        increment = decay;
+        break;
+    case Stage::Sustain:
+        progress = 0;
+        increment = 0;
+        level = sustain;
+        break;
+    case Stage::Release:
+        progress = decayProgress(level);
+        increment = release;
+        break;
+    }
+}
+
+double Envelope::genNextOutput()
+{
+    // Each stage first checks whether it has finished, using the values from
+    // the previous sample, the same as Envelope::doStage()
+    switch (stage) {
+    case Stage::Idle:
+        break;
+    case Stage::Delay:
+        if (delayProgress >= maxProgress) {
+            setStage(Stage::Attack);
+        } else {
+            delayProgress += increment;
+            if (level > 0) {
+                level = decayLevel(progress);
+                progress += increment;
+            }
+        }
+        break;
+    case Stage::Attack:
+        if (progress >= maxProgress) {
+            level = max_level_t;
+            setStage(Stage::Decay);
+        } else {
+            level = attackLevel(progress);
+            progress += increment;
+        }
+        break;
+    case Stage::Decay:
+        if (level <= sustain || progress >= maxProgress) {
+            setStage(loop ? Stage::Release : Stage::Sustain);
+        } else {
+            level = std::min(decayLevel(progress) + sustain, double(max_level_t));
+            progress += increment;
+        }
+        break;
+    case Stage::Sustain:
+        level = sustain;
+        break;
+    case Stage::Release:
+        if (level <= 0 || progress >= maxProgress) {
+            setStage((loop && gateOn) ? Stage::Delay : Stage::Idle);
+        } else {
+            level = decayLevel(progress);
+            progress += increment;
+        }
+        break;
+    }
+    return level;
+}
+
+double Operator::levelFromParam(param_t param)
+{
+    if (param > max_param_t) {
+        param = max_param_t;
+    }
+    return std::clamp(std::exp(param * 0.00775) * 23.6285 - 24, 0.0, double(max_level_t));
+}
+
+void Operator::setOpParams(const Patches::OpParams& paramsIn)
+{
+    params = paramsIn;
+    outputLevel = levelFromParam(params.outputLevel) / max_level_t;
+    // The engine's rounded level decides whether a carrier is counted
+    fMuted = (Dexy::Operator::makeSettings(params).outputLevel == 0);
+    if (params.fixedFreq) {
+        increment = SineWave::getIncrementForMidiNoteFast(midiNote_t(params.noteOrFreq));
+    }
+    env.setParams(params.env);
+}
+
+void Operator::setNotePitch(phase_t pitch)
+{
+    if (!params.fixedFreq) {
+        increment = Dexy::Operator::scalePitch(pitch, freqRatio_t(params.noteOrFreq));
+    }
+}
+
+double Operator::genNextOutput(double freqMod, output_t ampMod)
+{
+    double envLevel = params.useEnvelope ? env.genNextOutput() / max_level_t : 1.0;
+    // Phase modulation has the same scale as SineWave::genNextOutput()
+    double position = double(phase & mask_low_bits(cbitsPhase)) + freqMod * (1 << 12);
+    double sine = std::sin(2 * std::numbers::pi * position / double(1u << cbitsPhase)) * max_output_t;
+    phase += increment;
+    // Amplitude modulation level, as in Operator::calcAmpModLevel()
+    double ampModLevel = (max_level_t + params.ampModSens * (ampMod / 1024.0 - 32)) / max_level_t;
+    return sine * envLevel * ampModLevel * outputLevel;
+}
+
+void Voice::setPatch(const Patches::Patch& patch)
+{
+    iAlgorithm = patch.algorithm;
+    feedbackAmount = patch.feedbackAmount;
+    for (auto&& [op, params] : std::views::zip(operators, patch.opParams)) {
+        op.setOpParams(params);
+    }
+}
+
+void Voice::setNotePitch(phase_t pitch)
+{
+    for (auto&& op : operators) {
+        op.setNotePitch(pitch);
+    }
+}
+
+void Voice::gateStart()
+{
+    for (auto&& op : operators) {
+        op.gateStart();
+    }
+}
+
+void Voice::gateStop()
+{
+    for (auto&& op : operators) {
+        op.gateStop();
+    }
+}
+
+double Voice::genNextOutput(output_t ampMod)
+{
+    // The same routing as genOpOutput() in Voice.cpp, but every operator is
+    // calculated
+    double outputTotal = 0;
+    int numOutputs = 0;
+    double freqModPrev = 0;
+    double freqModSaved = 0;
+    for (auto&& [op, algoOp] : std::views::zip(operators, Synth::algorithms[iAlgorithm].ops)) {
+        double freqMod = 0;
+        switch (algoOp.mod) {
+        case Synth::UseMod::prev: freqMod = freqModPrev; break;
+        case Synth::UseMod::saved: freqMod = freqModSaved; break;
+        case Synth::UseMod::fb: freqMod = feedbackAmount * (feedback0 + feedback1) / 2 / (1024 * 20); break;
+        case Synth::UseMod::none: break;
+        }
+        double outputOp = op.genNextOutput(freqMod, ampMod);
+        if (algoOp.isOutput) {
+            if (!op.isMuted()) {
+                outputTotal += outputOp;
+                ++numOutputs;
+            }
+        } else {
+            freqModPrev = outputOp;
+            if (algoOp.saveMod == Synth::SaveMod::set) {
+                freqModSaved = outputOp;
+            } else if (algoOp.saveMod == Synth::SaveMod::add) {
+                freqModSaved += outputOp;
+            }
+        }
+        if (algoOp.setFb) {
+            feedback1 = feedback0;
+            feedback0 = outputOp;
+        }
+    }
+    return outputTotal / std::max(numOutputs, 1);
+}
+
+void Voice::genNextBlock(std::span<double> outputs, output_t ampMod)
+{
+    for (auto&& output : outputs) {
+        output = genNextOutput(ampMod);
+    }
+}
+
+} } // namespace Reference
@@ -0,0 +1,157 @@
+#pragma once
+
+// ReferenceVoice - Double-precision reference implementation of a synth voice,
+// for measuring the accuracy of the fixed-point engine (see tools/DexyCompare)
+//
+// These classes do the same things as Dexy::Envelope, Dexy::Operator and
+// Dexy::Synth::Voice, but calculate every value from the formulas that the
+// engine's lookup tables are made from, in double precision, with no tables,
+// interpolation, truncation or control-rate shortcuts. The modulation routing
+// comes from the same algorithm definitions (SynthAlgos.h).
+//
+// The operators' phase increments are the engine's own, so tuning is not part
+// of the comparison and the two stay in phase for as long as a note lasts.
+
+namespace Dexy { namespace Reference {
+
+/// @brief Double-precision version of Dexy::Envelope
+/// @details The same DADSR stages, stage transitions, rates and curves as
+/// Dexy::Envelope. Levels are in level_t units (0 to max_level_t) but are not
+/// rounded, and the position in each stage (progress) is in the same units as
+/// Envelope::progress_t but not truncated.
+class Envelope
+{
+public:
+    /// @brief Set envelope parameters
+    void setParams(const Patches::EnvParams& params);
+
+    /// @brief Gate start signal has been received - Start the envelope running
+    void gateStart();
+
+    /// @brief Gate stop signal has been received - Start the envelope's release stage
+    void gateStop();
+
+    /// @brief Generate the next envelope value
+    double genNextOutput();
+
+    /// @brief Is the envelope idle?
+    bool isIdle() const { return stage == Stage::Idle; }
+
+    /// @brief Get the current envelope level
+    double getLevel() const { return level; }
+
+    /// @brief Convert a rate setting to a rate (the increment of progress per
+    /// sample), as Envelope's rate table does
+    static double rateFromParam(param_t param);
+
+    /// @brief Attack curve: level at a given progress
+    static double attackLevel(double progress);
+
+    /// @brief Inverse of attackLevel(): progress at a given level
+    static double attackProgress(double level);
+
+    /// @brief Decay/release curve: level at a given progress
+    static double decayLevel(double progress);
+
+    /// @brief Inverse of decayLevel(): progress at a given level
+    static double decayProgress(double level);
+
+private:
+    enum class Stage { Idle, Delay, Attack, Decay, Sustain, Release };
+
+    /// @brief Change stage and initialize it, like Envelope::setStage()
+    void setStage(Stage stageNew);
+
+    // Settings
+    double delay = 0;
+    double attack = 0;
+    double decay = 0;
+    double sustain = max_level_t;
+    double release = 0;
+    bool loop = false;
+
+    // State
+    Stage stage = Stage::Idle;
+    double progress = 0;
+    double delayProgress = 0;
+    double increment = 0;
+    double level = 0;
+    bool gateOn = false;
+};
+
+/// @brief Double-precision version of Dexy::Operator: a sine oscillator
+/// scaled by an Envelope, the output level and amplitude modulation
+class Operator
+{
+public:
+    /// @brief Set the operator's parameters from a Patch
+    void setOpParams(const Patches::OpParams& params);
+
+    /// @brief Set the note pitch
+    /// @details The phase increment is the same as Dexy::Operator's.
+    /// @param pitch Phase increment corresponding to the note pitch
+    void setNotePitch(phase_t pitch);
+
+    void gateStart() { env.gateStart(); }
+    void gateStop() { env.gateStop(); }
+
+    /// @brief Generate the next output value
+    /// @param freqMod Frequency (phase) modulation, in output_t units
+    /// @param ampMod Amplitude modulation value
+    /// @return Output value in output_t units
+    double genNextOutput(double freqMod, output_t ampMod);
+
+    /// @brief Is the output level so low that the engine treats the operator
+    /// as muted?
+    /// @details A muted carrier isn't counted when the carriers are averaged.
+    bool isMuted() const { return fMuted; }
+
+    /// @brief Convert a level setting to a level, as Operator's level table
+    /// does
+    /// @return Level in level_t units, not rounded
+    static double levelFromParam(param_t param);
+
+private:
+    Patches::OpParams params;
+    double outputLevel = 1;     ///< Output level, 0 to 1
+    bool fMuted = false;
+    phase_t phase = 0;
+    phase_t increment = 0;
+    Envelope env;
+};
+
+/// @brief Double-precision version of Dexy::Synth::Voice
+class Voice
+{
+public:
+    /// @brief Set the Voice's settings from a Patch
+    /// @details The operators' waveforms are reset but their envelopes are
+    /// not, the same as Dexy::Synth::Voice::setSettings().
+    void setPatch(const Patches::Patch& patch);
+
+    /// @brief Set the pitch of the note
+    /// @param pitch Phase increment corresponding to the note pitch
+    void setNotePitch(phase_t pitch);
+
+    void gateStart();
+    void gateStop();
+
+    /// @brief Generate the next output value
+    /// @param ampMod Timbre modulation value
+    /// @return Output value in output_t units, not rounded
+    double genNextOutput(output_t ampMod);
+
+    /// @brief Generate a block of output values
+    /// @param[out] outputs Buffer to fill with output values
+    /// @param ampMod Timbre modulation value for the block
+    void genNextBlock(std::span<double> outputs, output_t ampMod);
+
+private:
+    std::array<Operator, numOperators> operators;
+    unsigned iAlgorithm = 0;
+    double feedbackAmount = max_param_t;
+    double feedback0 = 0;   ///< Current output of the feedback operator
+    double feedback1 = 0;   ///< Previous output of the feedback operator
+};
+
+} } // namespace Reference
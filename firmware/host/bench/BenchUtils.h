@@ -0,0 +1,76 @@
+// BenchUtils - Helpers for the host benchmarks
+
+#pragma once
+
+#include "DexyCore.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Dexy { namespace BenchUtils {
+
+/// @brief Read a monotonic clock in nanoseconds
+inline uint64_t readNanoseconds()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// @brief Read a cycle counter if there is one, otherwise nanoseconds
+inline uint64_t readCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return readNanoseconds();
+#endif
+}
+
+/// @brief Units of readCycles()
+#if defined(__x86_64__) || defined(__i386__)
+constexpr const char* cycleUnits = "TSC cycles";
+#else
+constexpr const char* cycleUnits = "ns";
+#endif
+
+/// @brief Somewhere to store a result so the compiler can't optimize away
+/// the calculations being timed
+inline volatile unsigned sink = 0;
+
+/// @brief Time a function, taking the best of several runs
+/// @param func Function to time
+/// @param numReps Number of runs
+/// @return Cycles (or ns) for the fastest run
+template<typename FUNC>
+uint64_t timeBest(FUNC func, int numReps = 20)
+{
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (int rep = 0; rep < numReps; ++rep) {
+        uint64_t tStart = readCycles();
+        func();
+        best = std::min(best, readCycles() - tStart);
+    }
+    return best;
+}
+
+/// @brief Time a function in nanoseconds, taking the best of several runs
+/// @details setup() is called before each run and isn't timed.
+/// @param setup Function to prepare for a run
+/// @param func Function to time
+/// @param numReps Number of runs
+/// @return Nanoseconds for the fastest run
+template<typename SETUP, typename FUNC>
+uint64_t timeBestNs(SETUP setup, FUNC func, int numReps = 20)
+{
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (int rep = 0; rep < numReps; ++rep) {
+        setup();
+        uint64_t tStart = readNanoseconds();
+        func();
+        best = std::min(best, readNanoseconds() - tStart);
+    }
+    return best;
+}
+
+} } // namespace BenchUtils
@@ -0,0 +1,190 @@
+// GainStagingBench - Operator output scaled by the envelope, amplitude
+// modulation and output level one after another (Operator::genNextOutput())
+// vs. one multiply by a precalculated gain (Operator::calcGain() &
+// Operator::applyGain(), used with OPERATOR_FOLDED_GAIN)
+
+#include "BenchUtils.h"
+
+using namespace Dexy;
+using namespace Dexy::BenchUtils;
+
+/// @brief The default calculation: three scaling steps, each truncated
+static output_t applyLevelsThreeStep(output_t amplitude, level_t envLevel, level_t outputLevel,
+                                     param_t ampModSens, output_t ampMod)
+{
+    output_t output = Operator::adjustOutputLevel(amplitude, envLevel);
+    output = Operator::adjustOutputLevel(output, Operator::calcAmpModLevel(ampModSens, ampMod));
+    return Operator::adjustOutputLevel(output, outputLevel);
+}
+
+/// @brief Small pseudo-random number generator (xorshift32), so that the
+/// results are the same every time
+static uint32_t rng = 2463534242u;
+static uint32_t nextRandom()
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/// @brief Compare the two calculations over random inputs and print a report
+static void reportAccuracy()
+{
+    constexpr unsigned numTrials = 20'000'000;
+    constexpr int maxDiffCounted = 3;
+    uint64_t counts[2 * maxDiffCounted + 1] = {};
+    uint64_t numOutside = 0;
+    int minDiff = 0;
+    int maxDiff = 0;
+    int64_t sumDiff = 0;
+    double maxErrorThreeStep = 0;
+    double maxErrorFolded = 0;
+    for (unsigned i = 0; i < numTrials; ++i) {
+        uint32_t r = nextRandom();
+        output_t amplitude = output_t(r);
+        level_t envLevel = level_t(r >> 16);
+        r = nextRandom();
+        // Every 16th trial uses the extremes of the other inputs
+        level_t outputLevel = level_t(r);
+        param_t ampModSens = param_t((r >> 16) % (max_param_t + 1));
+        output_t ampMod = output_t(nextRandom());
+        if ((r >> 28) == 0) {
+            envLevel = ((r >> 20) & 1) ? max_level_t : 0;
+            ampMod = ((r >> 21) & 1) ? output_t(32767) : output_t(-32768);
+            ampModSens = ((r >> 22) & 1) ? max_param_t : 0;
+        }
+        output_t expected = applyLevelsThreeStep(amplitude, envLevel, outputLevel, ampModSens, ampMod);
+        output_t actual = Operator::applyGain(amplitude, envLevel,
+                                              Operator::calcGain(outputLevel, ampModSens, ampMod));
+        int diff = actual - expected;
+        // Compare both with the unrounded product of all the levels
+        double ampModLevel = int32_t(ampModSens) * int32_t(ampMod) / 1024 + (65535 - int32_t(ampModSens) * 32);
+        double exact = amplitude * ((envLevel + 1) / 65536.0) * ((ampModLevel + 1) / 65536.0)
+                       * ((outputLevel + 1) / 65536.0);
+        maxErrorThreeStep = std::max(maxErrorThreeStep, std::abs(expected - exact));
+        maxErrorFolded = std::max(maxErrorFolded, std::abs(actual - exact));
+        minDiff = std::min(minDiff, diff);
+        maxDiff = std::max(maxDiff, diff);
+        sumDiff += diff;
+        if (diff < -maxDiffCounted || diff > maxDiffCounted)
+            ++numOutside;
+        else
+            ++counts[diff + maxDiffCounted];
+    }
+    printf("Folded gain vs. three-step scaling, %u random inputs:\n", numTrials);
+    for (int diff = -maxDiffCounted; diff <= maxDiffCounted; ++diff) {
+        uint64_t count = counts[diff + maxDiffCounted];
+        if (count != 0)
+            printf("  diff %+d: %10llu (%.3f%%)\n", diff, (unsigned long long)count, count * 100.0 / numTrials);
+    }
+    if (numOutside != 0)
+        printf("  larger: %10llu\n", (unsigned long long)numOutside);
+    printf("  range %+d..%+d, mean %+.4f\n", minDiff, maxDiff, double(sumDiff) / numTrials);
+    printf("  max error vs. unrounded: three-step %.2f, folded %.2f\n", maxErrorThreeStep, maxErrorFolded);
+
+    // Every operator level at maximum must leave the output unchanged
+    unsigned numChanged = 0;
+    const uint16_t gainMax = Operator::calcGain(max_level_t, 0, 0);
+    for (int a = -32768; a <= 32767; ++a) {
+        numChanged += (Operator::applyGain(output_t(a), max_level_t, gainMax) != a);
+    }
+    printf("  all levels at maximum: %u of 65536 outputs changed\n", numChanged);
+}
+
+/// @brief Samples per block, the same as Core1
+constexpr unsigned blockSize = 8;
+
+/// @brief Number of blocks per measurement
+constexpr unsigned numBlocks = 4096;
+
+/// @brief Inputs for the timing, one block for each operator
+static output_t amplitudes[numOperators][blockSize];
+static level_t envLevels[numOperators][blockSize];
+static level_t outputLevels[numOperators];
+static param_t ampModSenses[numOperators];
+static uint16_t gains[numOperators];
+static level_t ampModLevels[numOperators];
+
+/// @brief Time: three-step scaling of every operator's output, with the
+/// amplitude modulation level calculated for every sample
+__attribute__((noinline))
+static void timeThreeStep()
+{
+    int total = 0;
+    for (unsigned iBlock = 0; iBlock < numBlocks; ++iBlock) {
+        const output_t ampMod = output_t(iBlock);
+        for (unsigned i = 0; i < blockSize; ++i) {
+            for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+                total += applyLevelsThreeStep(amplitudes[iOp][i], envLevels[iOp][i],
+                                              outputLevels[iOp], ampModSenses[iOp], ampMod);
+            }
+        }
+    }
+    sink = unsigned(total);
+}
+
+/// @brief Time: three-step scaling with the amplitude modulation level
+/// calculated once per block (Operator::genNextOutput())
+__attribute__((noinline))
+static void timeThreeStepPerBlock()
+{
+    int total = 0;
+    for (unsigned iBlock = 0; iBlock < numBlocks; ++iBlock) {
+        const output_t ampMod = output_t(iBlock);
+        for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+            ampModLevels[iOp] = Operator::calcAmpModLevel(ampModSenses[iOp], ampMod);
+        }
+        for (unsigned i = 0; i < blockSize; ++i) {
+            for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+                output_t output = Operator::adjustOutputLevel(amplitudes[iOp][i], envLevels[iOp][i]);
+                output = Operator::adjustOutputLevel(output, ampModLevels[iOp]);
+                total += Operator::adjustOutputLevel(output, outputLevels[iOp]);
+            }
+        }
+    }
+    sink = unsigned(total);
+}
+
+/// @brief Time: folded gain, recalculated for every block as though the
+/// amplitude modulation changed every time
+__attribute__((noinline))
+static void timeFolded()
+{
+    int total = 0;
+    for (unsigned iBlock = 0; iBlock < numBlocks; ++iBlock) {
+        const output_t ampMod = output_t(iBlock);
+        for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+            gains[iOp] = Operator::calcGain(outputLevels[iOp], ampModSenses[iOp], ampMod);
+        }
+        for (unsigned i = 0; i < blockSize; ++i) {
+            for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+                total += Operator::applyGain(amplitudes[iOp][i], envLevels[iOp][i], gains[iOp]);
+            }
+        }
+    }
+    sink = unsigned(total);
+}
+
+int main()
+{
+    reportAccuracy();
+
+    for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+        for (unsigned i = 0; i < blockSize; ++i) {
+            amplitudes[iOp][i] = output_t(nextRandom());
+            envLevels[iOp][i] = level_t(nextRandom());
+        }
+        outputLevels[iOp] = level_t(40000 + 4000 * iOp);
+        ampModSenses[iOp] = param_t(100 * iOp);
+    }
+    constexpr unsigned numUnits = numBlocks * blockSize * numOperators;
+    double threeStep = double(timeBest(timeThreeStep)) / numUnits;
+    double perBlock = double(timeBest(timeThreeStepPerBlock)) / numUnits;
+    double folded = double(timeBest(timeFolded)) / numUnits;
+    printf("Time (%s per operator sample):\n", cycleUnits);
+    printf("  three-step            %8.2f\n", threeStep);
+    printf("  three-step, per block %8.2f %+7.1f%%\n", perBlock, (perBlock - threeStep) * 100 / threeStep);
+    printf("  folded                %8.2f %+7.1f%%\n", folded, (folded - threeStep) * 100 / threeStep);
+    return 0;
+}
@@ -0,0 +1,301 @@
+// HotPathBench - Timings of the per-sample hot path: the whole synth with each
+// of the algorithms, an Operator, each Envelope stage and the sine WaveTable
+// lookup
+//
+// Usage: HotPathBench [--json file]
+//
+// Results are in ns per sample and samples per second, the best of several
+// runs. All the inputs are fixed (including the seed for random phases) so
+// results from different builds can be compared directly. With --json the
+// results are also written to a file, for tracking over time.
+
+#include "BenchUtils.h"
+
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace Dexy;
+using namespace Dexy::BenchUtils;
+
+/// @brief Number of samples per measurement
+constexpr unsigned numSamples = 65536;
+
+/// @brief Number of runs per measurement (the fastest is reported)
+constexpr int numReps = 10;
+
+/// @brief Seed for random inputs
+constexpr unsigned randomSeed = 1357;
+
+/// @brief One measurement
+struct Result
+{
+    std::string group;
+    std::string name;
+    double nsPerSample;
+};
+
+static std::vector<Result> results;
+
+/// @brief Record and print a measurement
+/// @param ns Time for numSamples samples
+static void record(const char* group, const std::string& name, uint64_t ns)
+{
+    double nsPerSample = double(ns) / numSamples;
+    results.push_back(Result{ group, name, nsPerSample });
+    printf("  %-32s %9.2f ns %12.0f samples/s\n", name.c_str(), nsPerSample, 1e9 / nsPerSample);
+}
+
+/// @brief Write the results as JSON
+static bool writeJson(const char* filename)
+{
+    std::ofstream file(filename);
+    file << "{\n  \"benchmark\": \"HotPathBench\",\n";
+    file << "  \"samplesPerMeasurement\": " << numSamples << ",\n";
+    file << "  \"randomSeed\": " << randomSeed << ",\n";
+    file << "  \"config\": {\n";
+#ifdef ENVELOPE_CONTROL_RATE
+    file << "    \"ENVELOPE_CONTROL_RATE\": " << ENVELOPE_CONTROL_RATE << ",\n";
+#else
+    file << "    \"ENVELOPE_CONTROL_RATE\": null,\n";
+#endif
+#ifdef WAVETABLE_HW_INTERP
+    file << "    \"WAVETABLE_HW_INTERP\": true,\n";
+#else
+    file << "    \"WAVETABLE_HW_INTERP\": false,\n";
+#endif
+#ifdef SINE_QUARTER_WAVE
+    file << "    \"SINE_QUARTER_WAVE\": true,\n";
+#else
+    file << "    \"SINE_QUARTER_WAVE\": false,\n";
+#endif
+#ifdef OPERATOR_FOLDED_GAIN
+    file << "    \"OPERATOR_FOLDED_GAIN\": true\n";
+#else
+    file << "    \"OPERATOR_FOLDED_GAIN\": false\n";
+#endif
+    file << "  },\n  \"results\": [\n";
+    for (auto&& [i, result] : std::views::enumerate(results)) {
+        char line[256];
+        snprintf(line, sizeof(line),
+            "    {\"group\": \"%s\", \"name\": \"%s\", \"nsPerSample\": %.3f, \"samplesPerSec\": %.0f}%s\n",
+            result.group.c_str(), result.name.c_str(), result.nsPerSample, 1e9 / result.nsPerSample,
+            (std::size_t(i) + 1 < results.size()) ? "," : "");
+        file << line;
+    }
+    file << "  ]\n}\n";
+    return bool(file);
+}
+
+/// @brief Patch for timing the synth: every operator audible, held at its
+/// sustain level
+static Patches::Patch makeSynthPatch(unsigned iAlgo)
+{
+    Patches::Patch patch;
+    for (auto&& [iOp, op] : std::views::enumerate(patch.opParams)) {
+        op.noteOrFreq = uint16_t(freqRatio1 * (iOp + 1));
+        op.env = Patches::EnvParams{ .attack = max_param_t, .decay = 500, .sustain = 900 };
+    }
+    patch.algorithm = uint8_t(iAlgo);
+    return patch;
+}
+
+/// @brief Synth::genNextOutput() and Synth::genNextBlock() for every algorithm
+static void benchSynth()
+{
+    printf("Synth (patch with all operators audible):\n");
+    constexpr unsigned blockSize = 8; // same as Core1
+    for (unsigned iAlgo = 0; iAlgo < numAlgorithms; ++iAlgo) {
+        Patches::getPatch(0) = makeSynthPatch(iAlgo);
+        Synth::loadPatch(0);
+        Synth::setNotePitch(SineWave::getIncrementForHz(220.0));
+        Synth::gateStart();
+        // Let the envelopes reach the sustain stage
+        for (unsigned i = 0; i < numSamples; ++i) {
+            Synth::genNextOutput();
+        }
+        uint64_t ns = timeBestNs([] { }, [] {
+            unsigned total = 0;
+            for (unsigned i = 0; i < numSamples; ++i) {
+                total += uint16_t(Synth::genNextOutput());
+            }
+            sink = total;
+        }, numReps);
+        record("synth", "algorithm " + std::to_string(iAlgo + 1) + " genNextOutput", ns);
+        ns = timeBestNs([] { }, [] {
+            std::array<output_t, blockSize> outputs;
+            unsigned total = 0;
+            for (unsigned i = 0; i < numSamples; i += blockSize) {
+                Synth::genNextBlock(outputs);
+                total += uint16_t(outputs[0]);
+            }
+            sink = total;
+        }, numReps);
+        record("synth", "algorithm " + std::to_string(iAlgo + 1) + " genNextBlock(8)", ns);
+        Synth::gateStop();
+    }
+}
+
+/// @brief Operator::genNextOutput(), with and without separate envelope
+/// levels
+static void benchOperator()
+{
+    printf("Operator (modulated by its own previous output):\n");
+    static OperatorBank bank;
+    Operator op = bank[0];
+    op.setOpParams(Patches::OpParams{ .env = Patches::EnvParams{ .attack = max_param_t, .sustain = 900 } });
+    op.setNotePitch(SineWave::getIncrementForHz(220.0));
+    op.gateStart();
+    uint64_t ns = timeBestNs([] { }, [op]() mutable {
+        output_t mod = 0;
+        unsigned total = 0;
+        for (unsigned i = 0; i < numSamples; ++i) {
+            mod = op.genNextOutput(mod);
+            total += uint16_t(mod);
+        }
+        sink = total;
+    }, numReps);
+    record("operator", "genNextOutput(freqMod)", ns);
+    ns = timeBestNs([] { }, [op]() mutable {
+        output_t mod = 0;
+        unsigned total = 0;
+        for (unsigned i = 0; i < numSamples; ++i) {
+            mod = op.genNextOutput(mod, level_t(50000 + (i & 0xFF)));
+            total += uint16_t(mod);
+        }
+        sink = total;
+    }, numReps);
+    record("operator", "genNextOutput(freqMod, envLevel)", ns);
+}
+
+/// @brief Envelope::genNextBlock() in each stage
+static void benchEnvelope()
+{
+    printf("Envelope (genNextBlock, blocks of 16):\n");
+    enum class Check { zero, rising, falling, constant };
+    struct Stage
+    {
+        const char* name;
+        Patches::EnvParams params;
+        bool fStart;    ///< gateStart() before the measurement
+        bool fStop;     ///< then gateStop()
+        Check check;    ///< Expected level during the measurement
+    };
+    // The rates are slow enough that each stage lasts for the whole
+    // measurement
+    static const Stage stages[] = {
+        { "idle", {}, false, false, Check::zero },
+        { "delay", { .delay = 900 }, true, false, Check::zero },
+        { "attack", { .attack = 150 }, true, false, Check::rising },
+        { "decay", { .attack = max_param_t, .decay = 150, .sustain = 0 }, true, false, Check::falling },
+        { "sustain", { .attack = max_param_t, .decay = max_param_t, .sustain = 800 }, true, false, Check::constant },
+        { "release", { .attack = max_param_t, .release = 150 }, true, true, Check::falling },
+    };
+    static Envelope env;
+    for (const Stage& stage : stages) {
+        auto setup = [&stage] {
+            env.setParams(stage.params);
+            env.stopEnvelope();
+            if (stage.fStart) {
+                env.gateStart();
+                // Get past any instantaneous stages
+                std::array<level_t, 32> levels;
+                env.genNextBlock(levels);
+                if (stage.fStop)
+                    env.gateStop();
+            }
+        };
+        auto run = [] {
+            std::array<level_t, 16> levels;
+            unsigned total = 0;
+            for (unsigned i = 0; i < numSamples; i += unsigned(levels.size())) {
+                env.genNextBlock(levels);
+                total += levels[0];
+            }
+            sink = total;
+        };
+        // Check that the envelope stays in the stage being measured
+        setup();
+        std::array<level_t, 1> first;
+        env.genNextBlock(first);
+        run();
+        level_t last = env.getLevel();
+        bool fOk = (stage.check == Check::zero) ? (first[0] == 0 && last == 0)
+            : (stage.check == Check::rising) ? (last > first[0] && last < max_level_t)
+            : (stage.check == Check::falling) ? (last < first[0] && last > 0)
+            : (last == first[0]);
+        if (!fOk) {
+            printf("  WARNING: envelope left the %s stage (levels %u -> %u)\n", stage.name, first[0], last);
+        }
+        record("envelope", stage.name, timeBestNs(setup, run, numReps));
+    }
+}
+
+/// @brief WaveTable::lookupInterpolate() and SineWave::genNextOutput() for
+/// the synth's sine table (SineWave::SineTable)
+static void benchWaveTable()
+{
+    printf("WaveTable (sine):\n");
+    using SineWave::SineTable;
+    const phase_t increment = SineWave::getIncrementForHz(440.0);
+    uint64_t ns = timeBestNs([] { }, [increment] {
+        phase_t phase = 0;
+        unsigned total = 0;
+        for (unsigned i = 0; i < numSamples; ++i) {
+            total += uint16_t(SineTable::lookupInterpolate(&phase, increment));
+        }
+        sink = total;
+    }, numReps);
+    record("wavetable", "lookupInterpolate sequential", ns);
+
+    static std::array<phase_t, 4096> phases;
+    std::mt19937 rng(randomSeed);
+    for (auto&& phase : phases) {
+        phase = phase_t(rng());
+    }
+    ns = timeBestNs([] { }, [] {
+        unsigned total = 0;
+        for (unsigned i = 0; i < numSamples; ++i) {
+            phase_t phase = phases[i % phases.size()];
+            total += uint16_t(SineTable::lookupInterpolate(&phase, 0));
+        }
+        sink = total;
+    }, numReps);
+    record("wavetable", "lookupInterpolate random", ns);
+
+    ns = timeBestNs([] { }, [increment] {
+        phase_t phase = 0;
+        unsigned total = 0;
+        for (unsigned i = 0; i < numSamples; ++i) {
+            total += uint16_t(SineWave::genNextOutput(&phase, increment, output_t(i)));
+        }
+        sink = total;
+    }, numReps);
+    record("wavetable", "SineWave::genNextOutput", ns);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* jsonFile = nullptr;
+    if (argc == 3 && std::string_view(argv[1]) == "--json") {
+        jsonFile = argv[2];
+    } else if (argc != 1) {
+        fputs("Usage: HotPathBench [--json file]\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    Patches::init();
+    Defer::init();
+    Synth::init();
+
+    benchSynth();
+    benchOperator();
+    benchEnvelope();
+    benchWaveTable();
+
+    if (jsonFile && !writeJson(jsonFile)) {
+        fprintf(stderr, "Error writing %s\n", jsonFile);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
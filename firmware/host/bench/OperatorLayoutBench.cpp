@@ -0,0 +1,185 @@
+// OperatorLayoutBench - Operator state stored as an array of structs (the
+// previous Operator class) vs. the structure of arrays in OperatorBank
+
+#include "BenchUtils.h"
+
+using namespace Dexy;
+using namespace Dexy::BenchUtils;
+
+/// @brief Stand-in for the previous Operator class, which stored all of an
+/// operator's state together
+/// @details Same members in the same order, and the same per-sample
+/// calculation as Operator::genNextOutput().
+struct AosOperator
+{
+    bool fixedFreq = false;
+    freqRatio_t freqRatio = freqRatio1;
+    level_t outputLevel = max_level_t;
+    bool useEnvelope = true;
+    param_t ampModSens = 0;
+#ifdef OPERATOR_FOLDED_GAIN
+    uint16_t gain = 1u << Operator::cbitsGain;
+#else
+    level_t ampModLevel = max_level_t;
+#endif
+    phase_t notePitch = 0;
+    SineWave::WaveGen sineWave;
+    Envelope env;
+
+    void setSettings(const Operator::Settings& settings, phase_t pitch)
+    {
+        fixedFreq = settings.fixedFreq;
+        freqRatio = settings.freqRatio;
+        notePitch = pitch;
+        sineWave.setIncrement(fixedFreq ? settings.fixedIncrement : Operator::scalePitch(pitch, freqRatio));
+        outputLevel = settings.outputLevel;
+        useEnvelope = settings.useEnvelope;
+        ampModSens = settings.ampModSens;
+        env.setSettings(settings.env);
+    }
+
+#ifdef OPERATOR_FOLDED_GAIN
+    void setAmpMod(output_t ampMod) { gain = Operator::calcGain(outputLevel, ampModSens, ampMod); }
+
+    output_t genNextOutput(output_t freqMod, level_t envLevel)
+    {
+        output_t output = sineWave.genNextOutput(freqMod);
+        return Operator::applyGain(output, useEnvelope ? envLevel : max_level_t, gain);
+    }
+#else
+    void setAmpMod(output_t ampMod) { ampModLevel = Operator::calcAmpModLevel(ampModSens, ampMod); }
+
+    output_t genNextOutput(output_t freqMod, level_t envLevel)
+    {
+        output_t output = sineWave.genNextOutput(freqMod);
+        if (useEnvelope) {
+            output = Operator::adjustOutputLevel(output, envLevel);
+        }
+        output = Operator::adjustOutputLevel(output, ampModLevel);
+        return Operator::adjustOutputLevel(output, outputLevel);
+    }
+#endif
+
+    void skipNextOutput() { sineWave.skip(); }
+
+    bool isAudible() const { return outputLevel != 0 && !(useEnvelope && env.isIdle()); }
+};
+
+static AosOperator aosOperators[numOperators];
+static OperatorBank soaOperators;
+
+/// @brief Get one operator from either layout
+/// @return An Operator view for SoA, or a reference to an AosOperator
+template<bool SOA>
+static decltype(auto) getOp(unsigned iOp)
+{
+    if constexpr (SOA)
+        return soaOperators[iOp];
+    else
+        return (aosOperators[iOp]);
+}
+
+/// @brief Samples per block, the same as Core1
+constexpr unsigned blockSize = 8;
+
+/// @brief Number of blocks per measurement
+constexpr unsigned numBlocks = 4096;
+
+/// @brief Envelope levels for a block (held constant so only the operator
+/// state is being measured)
+static level_t envLevels[numOperators][blockSize];
+
+/// @brief Render: a chain of six operators, each modulating the next, as in
+/// the synth's render loop
+template<bool SOA>
+__attribute__((noinline))
+static void render()
+{
+    int total = 0;
+    for (unsigned iBlock = 0; iBlock < numBlocks; ++iBlock) {
+        for (unsigned i = 0; i < blockSize; ++i) {
+            output_t mod = 0;
+            [&]<std::size_t... iOp>(std::index_sequence<iOp...>) {
+                ((mod = getOp<SOA>(numOperators - 1 - iOp).genNextOutput(mod,
+                        envLevels[numOperators - 1 - iOp][i])), ...);
+            }(std::make_index_sequence<numOperators>());
+            total += mod;
+        }
+    }
+    sink = unsigned(total);
+}
+
+/// @brief Skip: advance every operator's phase without calculating an output,
+/// as for operators that aren't audible
+template<bool SOA>
+__attribute__((noinline))
+static void skip()
+{
+    for (unsigned iBlock = 0; iBlock < numBlocks; ++iBlock) {
+        for (unsigned i = 0; i < blockSize; ++i) {
+            for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+                getOp<SOA>(iOp).skipNextOutput();
+            }
+            // Keep the compiler from combining the samples into one addition
+            asm volatile("" ::: "memory");
+        }
+    }
+}
+
+/// @brief Scan: find the audible operators, as done once per block
+template<bool SOA>
+__attribute__((noinline))
+static void scan()
+{
+    unsigned total = 0;
+    for (unsigned iBlock = 0; iBlock < numBlocks * blockSize; ++iBlock) {
+        unsigned audibleOps = 0;
+        for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+            audibleOps |= unsigned(getOp<SOA>(iOp).isAudible()) << iOp;
+        }
+        total += audibleOps;
+    }
+    sink = total;
+}
+
+/// @brief Time one workload in both layouts and print a line
+static void report(const char* name, void funcAos(), void funcSoa(), unsigned numUnits)
+{
+    double aos = double(timeBest(funcAos)) / numUnits;
+    double soa = double(timeBest(funcSoa)) / numUnits;
+    printf("  %-8s %8.2f %8.2f %+7.1f%%\n", name, aos, soa, (soa - aos) * 100 / aos);
+}
+
+int main()
+{
+    Patches::init();
+    Envelope::init();
+    SineWave::init();
+    const auto& patch = Patches::getPatch(0);
+    const phase_t pitch = SineWave::getIncrementForHz(220.0);
+    for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+        auto settings = Operator::makeSettings(patch.opParams[iOp]);
+        settings.useEnvelope = true;
+        aosOperators[iOp].setSettings(settings, pitch);
+        aosOperators[iOp].setAmpMod(1000);
+        Operator op = soaOperators[iOp];
+        op.setSettings(settings);
+        op.setNotePitch(pitch);
+        op.setAmpMod(1000);
+        for (unsigned i = 0; i < blockSize; ++i) {
+            envLevels[iOp][i] = level_t(40000 + 1000 * iOp + i);
+        }
+    }
+
+    printf("Operator state layout (%s per sample, all %u operators):\n", cycleUnits, numOperators);
+    printf("  %-8s %8s %8s %8s\n", "", "AoS", "SoA", "change");
+    report("render", render<false>, render<true>, numBlocks * blockSize);
+    report("skip", skip<false>, skip<true>, numBlocks * blockSize);
+    report("scan", scan<false>, scan<true>, numBlocks * blockSize);
+    printf("Size of operator state: AoS %zu bytes, SoA %zu bytes\n",
+        sizeof(aosOperators), sizeof(soaOperators));
+    puts("Note: the sine lookup is an out-of-line call in both layouts here. In the\n"
+        "firmware it is inlined, and with SoA the per-sample fields of all the\n"
+        "operators are in a few contiguous arrays.");
+    return 0;
+}
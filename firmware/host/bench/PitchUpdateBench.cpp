@@ -0,0 +1,104 @@
+// PitchUpdateBench - Time spent updating operator frequencies from the pitch
+// CV, per sample, with and without change detection
+//
+// "On change" is the firmware's own code: the PitchCv that
+// Core0::onTimerInterrupt() uses, with AdcMap's pitch table, calling
+// Synth::setNotePitch().
+// "Every sample" is a model of the code that PitchCv replaced, which no longer
+// exists: a 64-bit multiply for every operator at every sample. It uses the
+// same pitch table, so the difference is only the multiplies.
+
+#include "BenchUtils.h"
+
+#include <random>
+#include <vector>
+
+using namespace Dexy;
+using namespace Dexy::BenchUtils;
+
+using AdcMap::adcResult_t;
+
+/// @brief Frequency ratios of the operators in the default patch
+static std::array<freqRatio_t, numOperators> freqRatios;
+
+/// @brief Operator increments for the "before" version
+static std::array<phase_t, numOperators> increments;
+
+/// @brief Before (a model of the old code): every operator's frequency is
+/// recalculated at every sample with a 64-bit multiply
+__attribute__((noinline))
+static void updateAlways(adcResult_t adcValue)
+{
+    phase_t pitch = AdcMap::getIncrementForAdcValue(adcValue);
+    for (unsigned i = 0; i < numOperators; ++i) {
+        uint64_t temp = uint64_t(pitch) * uint64_t(freqRatios[i]);
+        increments[i] = phase_t(temp >> 11);
+    }
+}
+
+/// @brief Pitch CV processing, with the same settings as Core0
+using BenchPitchCv = PitchCv<adcResult_t, pitchCvHysteresis>;
+
+/// @brief After: the firmware's PitchCv, as called by Core0::onTimerInterrupt()
+__attribute__((noinline))
+static void updateChanged(adcResult_t adcValue)
+{
+    static BenchPitchCv pitchCv;
+    pitchCv.update(adcValue, AdcMap::getIncrementForAdcValue);
+}
+
+/// @brief Time one version over a stream of ADC readings
+/// @return Cycles (or ns) per sample, best of several runs
+template<typename FUNC>
+static double timeUpdates(FUNC func, const std::vector<adcResult_t>& adcValues)
+{
+    uint64_t best = timeBest([&] {
+        for (auto&& value : adcValues) {
+            func(value);
+        }
+    });
+    return double(best) / double(adcValues.size());
+}
+
+int main()
+{
+    Patches::init();
+    Defer::init();
+    Synth::init();
+    const auto& patch = Patches::getPatch(0);
+    for (unsigned i = 0; i < numOperators; ++i) {
+        freqRatios[i] = freqRatio_t(patch.opParams[i].noteOrFreq);
+    }
+
+    // One second of pitch CV: a held note with +/-1 ADC unit of noise, then a
+    // glide, then another held note
+    constexpr unsigned numSamples = unsigned(SineWave::freqSample);
+    std::mt19937 rng(5678);
+    std::vector<adcResult_t> adcValues(numSamples);
+    for (unsigned i = 0; i < numSamples; ++i) {
+        double level = (i < numSamples / 3) ? 1500.0
+            : (i < 2 * numSamples / 3) ? 1500.0 + 600.0 * (i - numSamples / 3) / (numSamples / 3.0)
+            : 2100.0;
+        adcValues[i] = adcResult_t(level + double(int(rng() % 3) - 1));
+    }
+
+    double cyclesAlways = timeUpdates(updateAlways, adcValues);
+    double cyclesChanged = timeUpdates(updateChanged, adcValues);
+    unsigned numUpdates = 0;
+    BenchPitchCv pitchCv;
+    for (auto&& value : adcValues) {
+        numUpdates += pitchCv.update(value, AdcMap::getIncrementForAdcValue);
+    }
+
+    printf("Pitch update cost per sample (%s), %u samples:\n", cycleUnits, numSamples);
+    printf("  every sample, 64-bit:      %6.2f\n", cyclesAlways);
+    printf("  on change, 32-bit:         %6.2f\n", cyclesChanged);
+    printf("  saved:                     %6.2f\n", cyclesAlways - cyclesChanged);
+    printf("  (the change test itself mispredicts on random ADC noise)\n");
+    printf("Operator updates per sample: %.4f -> %.4f\n",
+        double(numOperators), double(numUpdates) * numOperators / numSamples);
+    printf("64-bit multiplies per sample: %u -> 0\n", numOperators);
+    puts("Note: a 64-bit multiply is one instruction on the host but a library call\n"
+        "(__aeabi_lmul) on the Cortex M0+, so the host timings understate the saving.");
+    return 0;
+}
@@ -0,0 +1,225 @@
+// WaveTableBench - Cost and accuracy of each WaveTable interpolation policy,
+// for the sine, attack and decay tables, and of the full-wave and quarter-wave
+// sine table layouts
+
+#include "BenchUtils.h"
+
+#include <numbers>
+#include <random>
+#include <vector>
+
+using namespace Dexy;
+using namespace Dexy::BenchUtils;
+
+// Stand-ins for the tables in SineWave.cpp and Envelope.cpp, which aren't
+// visible outside the synth core. The formulas must be kept the same.
+
+/// @brief Ideal sine wave, at a table position in units of entries
+static double sineIdeal(double index)
+{
+    return std::sin(2 * std::numbers::pi / (sizeLookupTable - 1) * index) * max_output_t;
+}
+
+/// @brief Sine table entry (same as SineWave.cpp)
+static constexpr output_t sineEntry(std::size_t index, std::size_t numValues)
+{
+    constexpr output_t max = max_output_t;
+    double phase = 2 * std::numbers::pi / (numValues-1) * index;
+    double sine = std::sin(phase) * max;
+    return output_t(std::round(sine));
+}
+
+/// @brief Quarter-wave sine table entry (same as SineWave.cpp with
+/// SINE_QUARTER_WAVE)
+static constexpr output_t quarterSineEntry(std::size_t index, std::size_t numValues)
+{
+    constexpr output_t max = max_output_t;
+    double phase = std::numbers::pi / 2 / (numValues-1) * index;
+    double sine = std::sin(phase) * max;
+    return output_t(std::round(sine));
+}
+
+/// @brief Ideal attack curve, at a table position in units of entries
+static double attackIdeal(double index)
+{
+    return index * index * 0.2499962;
+}
+
+/// @brief Attack table entry (same as Envelope.cpp)
+static constexpr level_t attackEntry(std::size_t index, [[maybe_unused]] std::size_t numValues)
+{
+    return level_t(std::round(index * index * 0.2499962));
+}
+
+/// @brief Ideal decay curve, at a table position in units of entries
+static double decayIdeal(double index)
+{
+    return std::max(0.0, std::exp((sizeLookupTable - 1 - index) * 0.01) * 393.996 - 394);
+}
+
+/// @brief Decay table entry (same as Envelope.cpp)
+static constexpr level_t decayEntry(std::size_t index, std::size_t numValues)
+{
+    double value;
+    if (index == numValues-1) {
+        value = 0;
+    } else {
+        value = std::round(std::exp((numValues - 1 - index) * 0.01) * 393.996) - 394;
+    }
+    return level_t(value);
+}
+
+/// @brief Number of table lookups per measurement
+constexpr unsigned numLookups = 1 << 16;
+
+/// @brief Time lookups at a typical audio-rate increment
+/// @return Cycles (or ns) per lookup
+template<typename TABLE>
+__attribute__((noinline))
+static double timeLookups()
+{
+    uint64_t best = timeBest([] {
+        phase_t phase = 0;
+        int total = 0;
+        for (unsigned i = 0; i < numLookups; ++i) {
+            total += TABLE::lookupInterpolate(&phase, 0x12345);
+        }
+        sink = unsigned(total);
+    });
+    return double(best) / numLookups;
+}
+
+/// @brief Signal to noise ratio of table lookups compared with the ideal curve,
+/// at random positions
+/// @param[out] pMaxError Maximum absolute error
+/// @return SNR in dB
+template<typename TABLE>
+static double measureSnr(double funcIdeal(double), double* pMaxError)
+{
+    std::mt19937 rng(1357);
+    double signal = 0;
+    double noise = 0;
+    double maxError = 0;
+    for (unsigned i = 0; i < numLookups; ++i) {
+        phase_t phase = phase_t(rng()) & mask_low_bits(cbitsPhase);
+        double ideal = funcIdeal(double(phase) / (1 << cbitsLookupFraction));
+        double error = double(TABLE::lookupInterpolate(&phase, 0)) - ideal;
+        signal += ideal * ideal;
+        noise += error * error;
+        maxError = std::max(maxError, std::abs(error));
+    }
+    *pMaxError = maxError;
+    return 10 * std::log10(signal / noise);
+}
+
+/// @brief Power of one DFT bin (Goertzel algorithm)
+static double binPower(const std::vector<double>& samples, unsigned bin)
+{
+    double coeff = 2 * std::cos(2 * std::numbers::pi * bin / double(samples.size()));
+    double s1 = 0;
+    double s2 = 0;
+    for (double x : samples) {
+        double s0 = x + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+}
+
+/// @brief Total harmonic distortion of a sine wave generated from the table
+/// @details The frequency is chosen to be exactly on a DFT bin, so no window
+/// is needed.
+/// @return THD in dB relative to the fundamental (harmonics 2-10)
+template<typename TABLE>
+static double measureThd()
+{
+    constexpr unsigned numSamples = 1 << 16;
+    constexpr unsigned cycles = 1001;
+    constexpr phase_t increment = phase_t((uint64_t(cycles) << cbitsPhase) / numSamples);
+    static_assert((uint64_t(increment) * numSamples) == (uint64_t(cycles) << cbitsPhase));
+    std::vector<double> samples(numSamples);
+    phase_t phase = 0;
+    for (auto&& sample : samples) {
+        sample = TABLE::lookupInterpolate(&phase, increment);
+    }
+    double fundamental = binPower(samples, cycles);
+    double harmonics = 0;
+    for (unsigned h = 2; h <= 10; ++h) {
+        unsigned bin = (h * cycles) % numSamples;
+        if (bin > numSamples / 2)
+            bin = numSamples - bin;
+        harmonics += binPower(samples, bin);
+    }
+    return 10 * std::log10(harmonics / fundamental);
+}
+
+/// @brief Report one table with one interpolation policy
+template<typename VALUE_T, VALUE_T FUNC_CALC1(std::size_t, std::size_t), typename INTERPOLATE>
+static void report(const char* policyName, double funcIdeal(double), bool fSine)
+{
+    using Table = WaveTable<VALUE_T, sizeLookupTable, FUNC_CALC1, INTERPOLATE>;
+    double maxError;
+    double snr = measureSnr<Table>(funcIdeal, &maxError);
+    printf("  %-10s %8.2f %8.1f %10.1f", policyName, timeLookups<Table>(), snr, maxError);
+    if (fSine) {
+        printf(" %8.1f", measureThd<Table>());
+    }
+    printf("\n");
+}
+
+/// @brief Report one table with all interpolation policies
+template<typename VALUE_T, VALUE_T FUNC_CALC1(std::size_t, std::size_t)>
+static void reportTable(const char* tableName, double funcIdeal(double), bool fSine)
+{
+    printf("%s:\n  %-10s %8s %8s %10s%s\n", tableName, "policy", cycleUnits[0] == 'T' ? "cycles" : "ns",
+        "SNR dB", "max error", fSine ? "   THD dB" : "");
+    report<VALUE_T, FUNC_CALC1, Interpolate::Nearest>("Nearest", funcIdeal, fSine);
+    report<VALUE_T, FUNC_CALC1, Interpolate::Average3>("Average3", funcIdeal, fSine);
+    report<VALUE_T, FUNC_CALC1, Interpolate::Linear>("Linear", funcIdeal, fSine);
+    report<VALUE_T, FUNC_CALC1, Interpolate::Blend8>("Blend8", funcIdeal, fSine);
+}
+
+/// @brief Report one sine table layout
+template<typename TABLE>
+static void reportLayout(const char* layoutName, const char* policyName, std::size_t numEntries)
+{
+    double maxError;
+    double snr = measureSnr<TABLE>(sineIdeal, &maxError);
+    printf("  %-14s %-10s %6zu %8.2f %8.1f %10.1f %8.1f\n", layoutName, policyName,
+        numEntries * sizeof(output_t), timeLookups<TABLE>(), snr, maxError, measureThd<TABLE>());
+}
+
+/// @brief Report the full-wave and quarter-wave sine table layouts with one
+/// interpolation policy
+template<typename INTERPOLATE>
+static void reportLayouts(const char* policyName)
+{
+    using Full = WaveTable<output_t, sizeLookupTable, sineEntry, INTERPOLATE>;
+    // Same resolution in a quarter of the memory
+    using Quarter = QuarterWaveTable<output_t, cbitsLookupIndex - 2, quarterSineEntry, INTERPOLATE>;
+    // Same memory, 4 times the resolution
+    using QuarterX4 = QuarterWaveTable<output_t, cbitsLookupIndex, quarterSineEntry, INTERPOLATE>;
+    reportLayout<Full>("full", policyName, sizeLookupTable);
+    reportLayout<Quarter>("quarter", policyName, Quarter::numValues);
+    reportLayout<QuarterX4>("quarter x4", policyName, QuarterX4::numValues);
+}
+
+int main()
+{
+    printf("WaveTable lookup per policy (%s per lookup):\n", cycleUnits);
+    reportTable<output_t, sineEntry>("SineTable", sineIdeal, true);
+    reportTable<level_t, attackEntry>("AttackTable", attackIdeal, false);
+    reportTable<level_t, decayEntry>("DecayTable", decayIdeal, false);
+    puts("Note: on the Cortex M0+ each select in Average3 is a branch, and the\n"
+        "multiply in Linear is a single cycle, so the host timings understate\n"
+        "Linear's advantage. Interpolate::Hardware gives the same values as\n"
+        "Blend8; it isn't timed here because on the host it runs on a software\n"
+        "model of the interpolators.");
+
+    printf("\nSine table layouts (%s per lookup):\n  %-14s %-10s %6s %8s %8s %10s %8s\n", cycleUnits,
+        "layout", "policy", "bytes", cycleUnits[0] == 'T' ? "cycles" : "ns", "SNR dB", "max error", "THD dB");
+    reportLayouts<Interpolate::Average3>("Average3");
+    reportLayouts<Interpolate::Linear>("Linear");
+    reportLayouts<Interpolate::Blend8>("Blend8");
+    return 0;
+}
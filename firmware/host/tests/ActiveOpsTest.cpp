@@ -0,0 +1,76 @@
+// ActiveOpsTest - Tests for finding which operators need to be calculated,
+// based on the algorithm's modulation routing
+
+#include "TestUtils.h"
+
+using namespace Dexy;
+using namespace Dexy::Synth;
+
+constexpr unsigned allOps = mask_low_bits(numOperators);
+
+/// @brief Modulation targets follow the routing in the algorithm definitions
+static void testModTargets()
+{
+    // Algorithm 1: two stacks, with feedback on the top of the first one
+    constexpr const Algorithm& algo1 = algorithms[0];
+    static_assert(algo1.modTargets[0] == bitmask(1));
+    static_assert(algo1.modTargets[1] == bitmask(2));
+    static_assert(algo1.modTargets[2] == bitmask(3));
+    static_assert(algo1.modTargets[3] == 0);
+    static_assert(algo1.modTargets[4] == bitmask(5));
+    static_assert(algo1.modTargets[5] == 0);
+
+    // Algorithm 4: feedback from a carrier to the top of its stack
+    static_assert(algorithms[3].modTargets[2] == bitmask(0));
+
+    // Algorithm 32: all carriers, nothing modulated
+    static_assert(std::ranges::all_of(algorithms[31].modTargets, [](unsigned m) { return m == 0; }));
+
+    // Every modulator modulates something and there are no loops other
+    // than feedback.
+    for (auto&& algo : algorithms) {
+        for (unsigned iOp = 0; iOp < numOperators; ++iOp) {
+            CHECK(algo.ops[iOp].isOutput || algo.modTargets[iOp] != 0);
+            CHECK(algo.ops[iOp].isOutput || algo.ops[iOp].setFb
+                  || (algo.modTargets[iOp] & ((2u << iOp) - 1)) == 0);
+        }
+    }
+}
+
+/// @brief Silent operators and unneeded modulators are skipped
+static void testActiveOps()
+{
+    constexpr const Algorithm& algo1 = algorithms[0];
+    // Everything audible - everything is calculated
+    static_assert(algo1.findActiveOps(allOps) == allOps);
+    // Silent carrier - its modulator stack is skipped too
+    static_assert(algo1.findActiveOps(allOps & ~bitmask(3)) == bitmask(4, 5));
+    static_assert(algo1.findActiveOps(allOps & ~bitmask(5)) == bitmask(0, 1, 2, 3));
+    // Silent modulator in the middle of a stack - modulators above it are skipped
+    static_assert(algo1.findActiveOps(allOps & ~bitmask(1)) == bitmask(2, 3, 4, 5));
+
+    // Feedback from a modulator to an earlier operator keeps it needed
+    constexpr Algorithm algoFb({
+        AlgoOp(false, UseMod::fb, SaveMod::none, false),
+        AlgoOp(false, UseMod::prev, SaveMod::none, true),
+        AlgoOp(true, UseMod::prev, SaveMod::none, false),
+        AlgoOp(true, UseMod::none, SaveMod::none, false),
+        AlgoOp(true, UseMod::none, SaveMod::none, false),
+        AlgoOp(true, UseMod::none, SaveMod::none, false),
+    });
+    static_assert(algoFb.modTargets[1] == bitmask(0, 2));
+    static_assert(algoFb.findActiveOps(allOps) == allOps);
+    static_assert(algoFb.findActiveOps(allOps & ~bitmask(2)) == bitmask(3, 4, 5));
+
+    for (auto&& algo : algorithms) {
+        CHECK(algo.findActiveOps(allOps) == allOps);
+        CHECK(algo.findActiveOps(0) == 0);
+    }
+}
+
+int main()
+{
+    testModTargets();
+    testActiveOps();
+    return TestUtils::result();
+}
@@ -0,0 +1,50 @@
+// AdcMapTest - Compare AdcMap's interpolated pitch table and fixed-point
+// timbre modulation with the double-precision calculations, for every ADC value
+
+#include "TestUtils.h"
+
+using namespace Dexy;
+
+/// @brief The pitch is within 0.5 cents everywhere
+static void testPitch()
+{
+    double maxErrorCents = 0;
+    for (unsigned value = 0; value <= AdcMap::maxAdcValue; ++value) {
+        phase_t increment = AdcMap::getIncrementForAdcValue(AdcMap::adcResult_t(value));
+        double exact = AdcMap::getExactIncrementForAdcValue(AdcMap::adcResult_t(value));
+        double errorCents = std::abs(1200.0 * std::log2(increment / exact));
+        if (errorCents >= 0.5) {
+            fprintf(stderr, "ADC %u: increment %u, exact %.0f\n", value, increment, exact);
+            CHECK(false);
+        }
+        maxErrorCents = std::max(maxErrorCents, errorCents);
+    }
+    printf("Pitch: max error %.3f cents\n", maxErrorCents);
+}
+
+/// @brief The timbre modulation is within 1 LSB everywhere and covers the
+/// whole output_t range
+static void testTimbreMod()
+{
+    int maxError = 0;
+    for (unsigned value = 0; value <= AdcMap::maxAdcValue; ++value) {
+        output_t timbreMod = AdcMap::getTimbreModForAdcValue(AdcMap::adcResult_t(value));
+        output_t exact = AdcMap::getExactTimbreModForAdcValue(AdcMap::adcResult_t(value));
+        int error = std::abs(int(timbreMod) - int(exact));
+        if (error > 1) {
+            fprintf(stderr, "ADC %u: timbre modulation %d, exact %d\n", value, timbreMod, exact);
+            CHECK(false);
+        }
+        maxError = std::max(maxError, error);
+    }
+    printf("Timbre modulation: max error %d LSB\n", maxError);
+    CHECK(AdcMap::getTimbreModForAdcValue(0) == min_output_t);
+    CHECK(AdcMap::getTimbreModForAdcValue(AdcMap::maxAdcValue) == max_output_t);
+}
+
+int main()
+{
+    testPitch();
+    testTimbreMod();
+    return TestUtils::result();
+}
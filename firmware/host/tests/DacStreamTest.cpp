@@ -0,0 +1,183 @@
+// DacStreamTest - Tests for the DAC command word format and DacStream, using a
+// model of the two chained DMA channels that send it at the sample rate
+
+#include "TestUtils.h"
+
+#include <thread>
+#include <vector>
+
+using namespace Dexy;
+
+/// @brief Model of the DMA output in SpiDac (DAC_OUTPUT_DMA)
+/// @details Two channels send the halves of the stream alternately, one word
+/// per sample timer tick, and interrupt when a half is done.
+template<unsigned SIZE>
+class DmaModel
+{
+public:
+    explicit DmaModel(DacStream<SIZE>& s) : stream(s) { }
+
+    /// @brief One sample timer tick - DMA sends one word to the PIO program
+    /// @return The command word that was sent
+    uint16_t tick()
+    {
+        fLastStale = fHalfStale;
+        uint16_t word = stream.getHalf(iHalf)[iWord];
+        if (++iWord == stream.halfSize) {
+            // Transfer complete: chain to the other channel, then interrupt
+            iWord = 0;
+            unsigned iHalfSent = iHalf;
+            iHalf = 1 - iHalf;
+            fHalfStale = !stream.onHalfSent(iHalfSent);
+            if (fHalfStale) {
+                ++numUnderruns;
+            }
+        }
+        return word;
+    }
+
+    unsigned numUnderruns = 0;
+
+    /// @brief Was the last word sent from a half that the producer hadn't filled?
+    bool fLastStale = false;
+
+private:
+    DacStream<SIZE>& stream;
+    unsigned iHalf = 0;
+    unsigned iWord = 0;
+    bool fHalfStale = false;
+};
+
+/// @brief Sample value for the nth output
+static uint16_t sampleValue(unsigned n) { return uint16_t(n * 0x1234u + 0x10u); }
+
+/// @brief MCP4821 command word layout
+static void testCommandFormat()
+{
+    using namespace Mcp482x;
+    // Unit A, gain 1x, not shut down, top 12 bits of the value
+    CHECK(makeCommand(0x0000, dacUnitA) == 0x3000);
+    CHECK(makeCommand(0x8000, dacUnitA) == 0x3800);
+    CHECK(makeCommand(0xFFFF, dacUnitA) == 0x3FFF);
+    CHECK(makeCommand(0x123F, dacUnitA) == 0x3123);
+    CHECK(makeCommand(0x8000, dacUnitB) == 0xB800);
+}
+
+/// @brief A producer that keeps up: after the initial silence, the DAC
+/// receives every value in order
+static void testInOrder()
+{
+    constexpr unsigned size = 32;
+    constexpr unsigned blockSize = 8;
+    DacStream<size> stream(0x8000);
+    DmaModel dma(stream);
+    std::vector<uint16_t> sent;
+    unsigned numWritten = 0;
+    // At each tick the producer writes blocks while there is space
+    for (unsigned t = 0; t < 10000; ++t) {
+        for (bool fSpace = true; fSpace; ) {
+            for (unsigned i = 0; i < blockSize; ++i) {
+                if (!stream.write(sampleValue(numWritten))) {
+                    // Blocks always fit in a half, so only the first write waits
+                    CHECK(i == 0);
+                    fSpace = false;
+                    break;
+                }
+                ++numWritten;
+            }
+        }
+        sent.push_back(dma.tick());
+    }
+    CHECK(dma.numUnderruns == 0);
+    CHECK(stream.getLowWaterMark() == stream.halfSize);
+    // The whole primed buffer is silence, then the samples follow
+    for (unsigned i = 0; i < size; ++i) {
+        CHECK(sent[i] == Mcp482x::makeCommand(0x8000, Mcp482x::dacUnitA));
+    }
+    for (unsigned i = size; i < sent.size(); ++i) {
+        CHECK(sent[i] == Mcp482x::makeCommand(sampleValue(i - size), Mcp482x::dacUnitA));
+    }
+    // The producer is never more than the buffer size ahead
+    CHECK(numWritten <= sent.size());
+    CHECK(numWritten + size >= sent.size());
+}
+
+/// @brief A producer that stalls is detected when DMA reaches an unfilled half
+static void testUnderrun()
+{
+    constexpr unsigned size = 16;
+    DacStream<size> stream(0);
+    DmaModel dma(stream);
+    unsigned numWritten = 0;
+    auto fill = [&] { while (stream.write(sampleValue(numWritten))) { ++numWritten; } };
+    for (unsigned t = 0; t < 100; ++t) {
+        fill();
+        dma.tick();
+    }
+    CHECK(dma.numUnderruns == 0);
+    // Stall for longer than one half
+    for (unsigned t = 0; t < size; ++t) {
+        dma.tick();
+    }
+    CHECK(dma.numUnderruns > 0);
+    CHECK(stream.getLowWaterMark() == 0);
+    // The stream recovers once the producer catches up
+    unsigned numUnderruns = dma.numUnderruns;
+    for (unsigned t = 0; t < 100; ++t) {
+        fill();
+        dma.tick();
+    }
+    CHECK(dma.numUnderruns == numUnderruns + 1);
+    stream.resetLowWaterMark();
+    for (unsigned t = 0; t < 100; ++t) {
+        fill();
+        dma.tick();
+    }
+    CHECK(dma.numUnderruns == numUnderruns + 1);
+    CHECK(stream.getLowWaterMark() == stream.halfSize);
+}
+
+/// @brief Producer and DMA model running in different threads
+/// @details The DMA thread doesn't wait for the producer, like the real thing,
+/// so it will underrun. Halves that were ready must contain the next values in
+/// sequence; stale halves are skipped.
+static void testThreads()
+{
+    constexpr unsigned size = 32;
+    constexpr unsigned numValues = 20000;
+    DacStream<size> stream(0);
+    DmaModel dma(stream);
+    std::thread producer([&] {
+        for (unsigned n = 0; n < numValues; ) {
+            if (stream.write(uint16_t(n << 4))) {
+                ++n;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    unsigned nextExpected = 0;
+    unsigned numOutOfOrder = 0;
+    for (unsigned t = 0; nextExpected < numValues; ++t) {
+        uint16_t value = dma.tick() & 0x0FFF;
+        if (t < size || dma.fLastStale) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (value != (nextExpected & 0x0FFF)) {
+            ++numOutOfOrder;
+        }
+        ++nextExpected;
+    }
+    producer.join();
+    CHECK(numOutOfOrder == 0);
+}
+
+int main()
+{
+    testCommandFormat();
+    testInOrder();
+    testUnderrun();
+    testThreads();
+    return TestUtils::result();
+}
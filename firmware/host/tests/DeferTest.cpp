@@ -0,0 +1,84 @@
+// DeferTest - Tests for the lock-free variant of Defer, including a stress
+// test with the caller and the implementer in different threads
+
+#include "TestUtils.h"
+
+#include <thread>
+
+using namespace Dexy;
+
+static unsigned lastArg = 0;
+static unsigned numRuns = 0;
+static unsigned numOutOfOrder = 0;
+
+static void deferredFunc(Defer::LockFree /*unused*/, unsigned arg)
+{
+    numOutOfOrder += (arg <= lastArg);
+    lastArg = arg;
+    ++numRuns;
+}
+
+static void resetCounts()
+{
+    lastArg = 0;
+    numRuns = 0;
+    numOutOfOrder = 0;
+}
+
+/// @brief Basic behaviour in a single thread
+static void testSingleThread()
+{
+    resetCounts();
+    CHECK(!Defer::checkRun<deferredFunc>());
+    Defer::call<deferredFunc>(1);
+    CHECK(Defer::checkRun<deferredFunc>());
+    CHECK(lastArg == 1);
+    CHECK(!Defer::checkRun<deferredFunc>());
+    // Only the latest call runs
+    Defer::call<deferredFunc>(2);
+    Defer::call<deferredFunc>(3);
+    CHECK(Defer::checkRun<deferredFunc>());
+    CHECK(lastArg == 3);
+    CHECK(numRuns == 2);
+    CHECK(!Defer::checkRun<deferredFunc>());
+    // clearPending
+    Defer::call<deferredFunc>(4);
+    Defer::clearPending<deferredFunc>();
+    CHECK(!Defer::checkRun<deferredFunc>());
+    CHECK(lastArg == 3);
+}
+
+/// @brief Caller and implementer in different threads
+/// @details The implementer must only ever see arguments that were passed to
+/// call(), in increasing order, and must see the last one.
+static void testThreads()
+{
+    constexpr unsigned numCalls = 200000;
+    resetCounts();
+    std::atomic<bool> fDone = false;
+    std::thread caller([&] {
+        for (unsigned i = 1; i <= numCalls; ++i) {
+            Defer::call<deferredFunc>(i);
+            if (i % 64 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        fDone = true;
+    });
+    while (!fDone) {
+        Defer::checkRun<deferredFunc>();
+    }
+    caller.join();
+    Defer::checkRun<deferredFunc>();
+    CHECK(numOutOfOrder == 0);
+    CHECK(lastArg == numCalls);
+    CHECK(numRuns > 0 && numRuns <= numCalls);
+    printf("%u calls, %u runs\n", numCalls, numRuns);
+}
+
+int main()
+{
+    testSingleThread();
+    testThreads();
+    return TestUtils::result();
+}
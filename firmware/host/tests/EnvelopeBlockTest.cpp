@@ -0,0 +1,108 @@
+// EnvelopeBlockTest - Tests for segment-based envelope rendering:
+// Envelope::genNextBlockExact() must give exactly the same levels as
+// genNextOutputExact()
+
+#include "TestUtils.h"
+
+#include <random>
+#include <vector>
+
+using namespace Dexy;
+
+/// @brief Parameter values to test - from slow to instantaneous
+constexpr param_t testRates[] = { 0, 500, 700, 850, 950, max_param_t };
+
+/// @brief Render the same envelope both ways, with gate events and a sustain
+/// change at random times, and compare every level
+static void testSameLevels(const Patches::EnvParams& params, std::mt19937& rng)
+{
+    Envelope exact;
+    Envelope block;
+    exact.setSettings(Envelope::makeSettings(params));
+    block.setSettings(Envelope::makeSettings(params));
+    std::array<level_t, 64> levels;
+    unsigned numMismatches = 0;
+    for (int event = 0; event < 12; ++event) {
+        switch (event % 4) {
+        case 0:
+            exact.gateStart();
+            block.gateStart();
+            break;
+        case 2:
+            exact.gateStop();
+            block.gateStop();
+            break;
+        case 3: {
+            // Live update of the sustain level
+            Patches::EnvParams paramsNew = params;
+            paramsNew.sustain = param_t(rng() % (max_param_t + 1));
+            exact.setSettings(Envelope::makeSettings(paramsNew));
+            block.setSettings(Envelope::makeSettings(paramsNew));
+            break;
+        }
+        default:
+            break;
+        }
+        // Random block sizes, including some single samples
+        unsigned numBlocks = 1 + rng() % 400;
+        for (unsigned iBlock = 0; iBlock < numBlocks; ++iBlock) {
+            std::size_t blockSize = (rng() % 4 == 0) ? 1 : 1 + rng() % levels.size();
+            block.genNextBlockExact(std::span(levels.data(), blockSize));
+            for (std::size_t i = 0; i < blockSize; ++i) {
+                numMismatches += (levels[i] != exact.genNextOutputExact());
+            }
+        }
+        CHECK(exact.isIdle() == block.isIdle());
+    }
+    CHECK(numMismatches == 0);
+}
+
+/// @brief All combinations of rates, with a few sustain levels
+static void testAllRates()
+{
+    std::mt19937 rng(2468);
+    for (param_t delay : { param_t(0), param_t(300) }) {
+        for (param_t attack : testRates) {
+            for (param_t decay : testRates) {
+                for (param_t release : testRates) {
+                    for (param_t sustain : { param_t(0), param_t(600), max_param_t }) {
+                        for (bool loop : { false, true }) {
+                            testSameLevels(Patches::EnvParams{
+                                .delay = delay, .attack = attack, .decay = decay,
+                                .sustain = sustain, .release = release, .loop = loop }, rng);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief Sustain and Idle are rendered as constant segments
+static void testConstantSegments()
+{
+    Envelope env;
+    env.setSettings(Envelope::makeSettings(Patches::EnvParams{
+        .delay = 0, .attack = max_param_t, .decay = max_param_t,
+        .sustain = 600, .release = max_param_t, .loop = false }));
+    std::vector<level_t> levels(1000);
+    env.genNextBlockExact(levels);
+    CHECK(std::ranges::all_of(levels, [](level_t level) { return level == 0; }));
+    env.gateStart();
+    env.genNextBlockExact(levels);
+    CHECK(levels.back() == Envelope::makeSettings(Patches::EnvParams{ .sustain = 600 }).sustain);
+    CHECK(std::ranges::all_of(levels | std::views::drop(100),
+                              [&](level_t level) { return level == levels.back(); }));
+    env.gateStop();
+    env.genNextBlockExact(levels);
+    CHECK(env.isIdle());
+    CHECK(levels.back() == 0);
+}
+
+int main()
+{
+    Envelope::init();
+    testAllRates();
+    testConstantSegments();
+    return TestUtils::result();
+}
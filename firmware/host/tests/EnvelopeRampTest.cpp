@@ -0,0 +1,151 @@
+// EnvelopeRampTest - Tests for control-rate envelopes: compare
+// Envelope::genNextOutputRamped() with the per-sample genNextOutputExact()
+
+#include "TestUtils.h"
+
+#include <vector>
+
+using namespace Dexy;
+
+/// @brief Maximum number of samples to run each part of a test envelope
+constexpr unsigned maxSamples = 2 * SineWave::freqSample;
+
+/// @brief Run both envelopes for up to numSamples samples, stopping when the
+/// exact one goes idle
+/// @return true if the envelopes went idle on the same sample (or neither did)
+template<unsigned PERIOD>
+static bool runBoth(Envelope& exact, Envelope& ramped, unsigned numSamples,
+                    std::vector<level_t>& levelsExact, std::vector<level_t>& levelsRamped)
+{
+    for (unsigned i = 0; i < numSamples; ++i) {
+        levelsExact.push_back(exact.genNextOutputExact());
+        levelsRamped.push_back(ramped.genNextOutputRamped(PERIOD));
+        if (exact.isIdle() || ramped.isIdle()) {
+            return exact.isIdle() && ramped.isIdle();
+        }
+    }
+    return true;
+}
+
+/// @brief Maximum difference between the ramped and exact levels
+static int maxDifference(const std::vector<level_t>& levelsExact, const std::vector<level_t>& levelsRamped)
+{
+    int maxDiff = 0;
+    for (std::size_t i = 0; i < levelsExact.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(int(levelsRamped[i]) - int(levelsExact[i])));
+    }
+    return maxDiff;
+}
+
+/// @brief Stage transitions happen on the same sample, and the ramps stay
+/// within the exact envelope's range
+template<unsigned PERIOD>
+static void testTransitions()
+{
+    int maxDiff = 0;
+    TestUtils::forEachEnvParams([&](const Patches::EnvParams& params) {
+        auto settings = Envelope::makeSettings(params);
+        Envelope exact;
+        Envelope ramped;
+        exact.setSettings(settings);
+        ramped.setSettings(settings);
+        std::vector<level_t> levelsExact;
+        std::vector<level_t> levelsRamped;
+
+        // Run until both are sustaining (or give up), ...
+        exact.gateStart();
+        ramped.gateStart();
+        level_t sustainLevel = settings.sustain;
+        unsigned iLastNotSustain = 0;
+        for (unsigned i = 0; i < maxSamples && (iLastNotSustain == 0 || i < iLastNotSustain + 4 * PERIOD); ++i) {
+            levelsExact.push_back(exact.genNextOutputExact());
+            levelsRamped.push_back(ramped.genNextOutputRamped(PERIOD));
+            if (levelsExact.back() != sustainLevel) {
+                iLastNotSustain = i;
+            }
+        }
+        // Reached the sustain level on the same sample
+        bool fSustaining = (iLastNotSustain != 0 && levelsExact.back() == sustainLevel);
+        auto itLastRamped = std::find_if(levelsRamped.rbegin(), levelsRamped.rend(),
+            [=](level_t level) { return level != sustainLevel; });
+        CHECK(!fSustaining
+              || unsigned(levelsRamped.rend() - itLastRamped) == iLastNotSustain + 1);
+
+        // ... then release - they start from the same level
+        // so they must go idle on exactly the same sample.
+        exact.gateStop();
+        ramped.gateStop();
+        bool fSameEnd = runBoth<PERIOD>(exact, ramped, maxSamples, levelsExact, levelsRamped);
+        CHECK(!fSustaining || fSameEnd);
+
+        // Each ramped level is within the range of the exact levels over the
+        // surrounding period
+        double outside = TestUtils::maxOutsideWindow<level_t, level_t>(levelsExact, levelsRamped,
+                                                                       [](std::size_t) { return PERIOD; });
+        CHECK(outside == 0);
+        maxDiff = std::max(maxDiff, maxDifference(levelsExact, levelsRamped));
+    });
+    printf("Period %2u: max deviation from the per-sample envelope = %d (%.2f%% of full scale)\n",
+        PERIOD, maxDiff, 100.0 * maxDiff / max_level_t);
+}
+
+/// @brief Retriggering during a ramp starts the new stage from the ramped
+/// level, so the envelopes diverge slightly but must stay close
+template<unsigned PERIOD>
+static void testRetrigger()
+{
+    auto settings = Envelope::makeSettings(Patches::EnvParams{
+        .delay = 0, .attack = 900, .decay = 800, .sustain = 500, .release = 700, .loop = false });
+    Envelope exact;
+    Envelope ramped;
+    exact.setSettings(settings);
+    ramped.setSettings(settings);
+    std::vector<level_t> levelsExact;
+    std::vector<level_t> levelsRamped;
+    for (unsigned numGate : { 1001u, 2003u, 307u, 5009u }) {
+        exact.gateStart();
+        ramped.gateStart();
+        runBoth<PERIOD>(exact, ramped, numGate, levelsExact, levelsRamped);
+        exact.gateStop();
+        ramped.gateStop();
+        runBoth<PERIOD>(exact, ramped, numGate / 2, levelsExact, levelsRamped);
+    }
+    int maxDiff = maxDifference(levelsExact, levelsRamped);
+    printf("Period %2u: max deviation with retriggering = %d\n", PERIOD, maxDiff);
+    CHECK(maxDiff < max_level_t / 16);
+}
+
+/// @brief Live changes to the sustain level are ramped
+static void testSustainChange()
+{
+    auto params = Patches::EnvParams{ .delay = 0, .attack = max_param_t, .decay = max_param_t,
+                                      .sustain = 400, .release = 500, .loop = false };
+    const level_t sustainLow = Envelope::makeSettings(params).sustain;
+    Envelope env;
+    env.setSettings(Envelope::makeSettings(params));
+    env.gateStart();
+    for (int i = 0; i < 100; ++i) {
+        env.genNextOutputRamped(16);
+    }
+    CHECK(env.genNextOutputRamped(16) == sustainLow);
+    params.sustain = 800;
+    env.setSettings(Envelope::makeSettings(params));
+    level_t levelPrev = sustainLow;
+    for (int i = 0; i < 32; ++i) {
+        level_t level = env.genNextOutputRamped(16);
+        CHECK(level >= levelPrev);
+        levelPrev = level;
+    }
+    CHECK(levelPrev == Envelope::makeSettings(params).sustain);
+}
+
+int main()
+{
+    Envelope::init();
+    testTransitions<16>();
+    testTransitions<32>();
+    testRetrigger<16>();
+    testRetrigger<32>();
+    testSustainChange();
+    return TestUtils::result();
+}
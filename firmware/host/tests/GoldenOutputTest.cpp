@@ -0,0 +1,333 @@
+// GoldenOutputTest - Bit-exact regression test of the synth's output
+//
+// Usage: GoldenOutputTest <golden-dir>
+//        GoldenOutputTest --update <golden-dir>
+//
+// Renders a fixed set of scenarios (every algorithm, the patches in
+// PatchData.h and the shipped patch bank, with gate on & off, retriggering in
+// the release stage, timbre and pitch changes) and compares a hash of each
+// scenario's output samples with the golden values in the file. Any change to
+// the sound, however small, makes this fail. If the change is intended (e.g. a
+// knowingly lossy optimization), run with --update to rewrite the file and
+// commit it with the change.
+//
+// Each combination of the optional settings in CompileDefs.h that change the
+// output has a golden file of its own in <golden-dir>: golden-output.txt for
+// the default build settings, or e.g. golden-output-hwinterp.txt with
+// WAVETABLE_HW_INTERP (see goldenFileName()). The test fails if the file for
+// this build doesn't exist.
+
+#include "TestUtils.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Dexy;
+using namespace Dexy::Synth;
+
+/// @brief Get the name of the golden file for this build's settings
+static std::string goldenFileName()
+{
+    std::string name = "golden-output";
+#ifdef ENVELOPE_CONTROL_RATE
+    name += "-ecr" + std::to_string(ENVELOPE_CONTROL_RATE);
+#endif
+#ifdef WAVETABLE_HW_INTERP
+    name += "-hwinterp";
+#endif
+#ifdef SINE_QUARTER_WAVE
+    name += "-quarterwave";
+#endif
+#ifdef OPERATOR_FOLDED_GAIN
+    name += "-foldedgain";
+#endif
+    return name + ".txt";
+}
+
+/// @brief Samples per block, the same as Core1
+constexpr unsigned blockSize = 8;
+
+/// @brief One step of a scenario: something to change, then samples to render
+struct Step
+{
+    enum class Action { gateStart, gateStop, pitch, timbre, timbreSweep };
+    Action action;
+    double value;           ///< Pitch in Hz or timbre value, for those actions
+    unsigned numSamples;    ///< Samples to render after the action (a multiple of blockSize)
+};
+
+using Script = std::vector<Step>;
+using Action = Step::Action;
+
+/// @brief Hold a note, then let it release
+static const Script scriptGate = {
+    { Action::pitch, 220.0, 0 },
+    { Action::gateStart, 0, 12000 },
+    { Action::gateStop, 0, 24000 },
+};
+
+/// @brief Start the note again during its release
+static const Script scriptRetrigger = {
+    { Action::pitch, 220.0, 0 },
+    { Action::gateStart, 0, 8000 },
+    { Action::gateStop, 0, 4000 },
+    { Action::gateStart, 0, 8000 },
+    { Action::gateStop, 0, 16000 },
+};
+
+/// @brief Sweep the timbre modulation across its whole range while holding a
+/// note
+static const Script scriptTimbre = {
+    { Action::pitch, 330.0, 0 },
+    { Action::gateStart, 0, 0 },
+    { Action::timbreSweep, 0, 16384 },
+    { Action::timbre, 0, 0 },
+    { Action::gateStop, 0, 8000 },
+};
+
+/// @brief Change the pitch while holding a note
+static const Script scriptPitch = {
+    { Action::pitch, 110.0, 0 },
+    { Action::gateStart, 0, 4000 },
+    { Action::pitch, 440.0, 4000 },
+    { Action::pitch, 1760.0, 4000 },
+    { Action::pitch, 27.5, 4000 },
+    { Action::gateStop, 0, 8000 },
+};
+
+/// @brief 64-bit FNV-1a hash of output samples (little-endian bytes)
+class Hash
+{
+public:
+    void add(std::span<const output_t> samples)
+    {
+        for (output_t sample : samples) {
+            addByte(uint8_t(uint16_t(sample)));
+            addByte(uint8_t(uint16_t(sample) >> 8));
+        }
+    }
+    uint64_t get() const { return hash; }
+
+private:
+    void addByte(uint8_t byte) { hash = (hash ^ byte) * 1099511628211ull; }
+    uint64_t hash = 14695981039346656037ull;
+};
+
+/// @brief Result of rendering a scenario
+struct Result
+{
+    std::string name;
+    unsigned numSamples;
+    uint64_t hash;
+};
+
+static std::vector<Result> results;
+
+/// @brief Render a scenario with a Voice of its own, so that each scenario is
+/// independent of the others
+static void render(const std::string& name, const Patches::Patch& patch, const Script& script)
+{
+    static Voice voice;
+    voice = Voice();
+    voice.setSettings(Voice::makeSettings(patch));
+    output_t timbre = 0;
+    Hash hash;
+    unsigned numSamples = 0;
+    for (const Step& step : script) {
+        switch (step.action) {
+        case Action::gateStart: voice.gateStart(); break;
+        case Action::gateStop: voice.gateStop(); break;
+        case Action::pitch: voice.setNotePitch(SineWave::getIncrementForHz(step.value)); break;
+        case Action::timbre: timbre = output_t(step.value); break;
+        case Action::timbreSweep: break;
+        }
+        for (unsigned i = 0; i < step.numSamples; i += blockSize) {
+            if (step.action == Action::timbreSweep) {
+                timbre = output_t(int32_t(INT16_MIN) + int32_t(i * 65535 / step.numSamples));
+            }
+            std::array<output_t, blockSize> outputs;
+            voice.genNextBlock(outputs, timbre);
+            hash.add(outputs);
+        }
+        numSamples += step.numSamples;
+    }
+    results.push_back(Result{ name, numSamples, hash.get() });
+}
+
+/// @brief Render through the Synth API, the same way as the firmware: patch
+/// handover, gate events applied at the start of a block (including a stop and
+/// start in the same block) and timbre modulation
+/// @details This must run first, because Synth's state carries on from one
+/// note to the next.
+static void renderSynth()
+{
+    Hash hash;
+    unsigned numSamples = 0;
+    auto run = [&](unsigned n) {
+        for (unsigned i = 0; i < n; i += blockSize) {
+            std::array<output_t, blockSize> outputs;
+            Synth::genNextBlock(outputs);
+            hash.add(outputs);
+        }
+        numSamples += n;
+    };
+    Synth::loadPatch(Synth::initialPatch);
+    Synth::setNotePitch(SineWave::getIncrementForHz(261.63));
+    Synth::gateStart();
+    run(8000);
+    Synth::setTimbreMod(20000);
+    run(4000);
+    // Retrigger within one block
+    Synth::gateStop();
+    Synth::gateStart();
+    run(4000);
+    Synth::gateStop();
+    run(4000);
+    // Change patch during the release, then play another note
+    Synth::loadPatch(0);
+    run(4000);
+    Synth::setTimbreMod(-20000);
+    Synth::setNotePitch(SineWave::getIncrementForHz(523.25));
+    Synth::gateStart();
+    run(8000);
+    Synth::gateStop();
+    run(16000);
+    results.push_back(Result{ "synth", numSamples, hash.get() });
+}
+
+/// @brief Render every scenario, in order
+static void renderAll()
+{
+    renderSynth();
+
+    // Every algorithm, with the default patch
+    for (unsigned iAlgo = 0; iAlgo < numAlgorithms; ++iAlgo) {
+        Patches::Patch patch = Patches::makeDefaultPatch();
+        patch.algorithm = uint8_t(iAlgo);
+        char name[32];
+        snprintf(name, sizeof(name), "algorithm-%02u/gate", iAlgo + 1);
+        render(name, patch, scriptGate);
+    }
+
+    // The patches in PatchData.h, with every script
+    const std::pair<const char*, Patches::Patch> dataPatches[] = {
+        { "default", Patches::makeDefaultPatch() },
+        { "bell", Patches::makeBellPatch() },
+        { "test", Patches::makeTestPatch() },
+    };
+    const std::pair<const char*, const Script*> scripts[] = {
+        { "gate", &scriptGate },
+        { "retrigger", &scriptRetrigger },
+        { "timbre", &scriptTimbre },
+        { "pitch", &scriptPitch },
+    };
+    for (auto&& [patchName, patch] : dataPatches) {
+        for (auto&& [scriptName, script] : scripts) {
+            render(std::string(patchName) + "/" + scriptName, patch, *script);
+        }
+    }
+
+    // The shipped patch bank (patches/default.dexy, built in)
+    for (unsigned iPatch = 0; iPatch < Patches::numPatches; ++iPatch) {
+        char name[32];
+        snprintf(name, sizeof(name), "bank-%02u", iPatch);
+        const Patches::Patch& patch = Patches::getPatch(iPatch);
+        render(std::string(name) + "/gate", patch, scriptGate);
+        render(std::string(name) + "/retrigger", patch, scriptRetrigger);
+    }
+}
+
+/// @brief Write the results as a golden file
+static bool writeGolden(const char* filename)
+{
+    std::ofstream file(filename);
+    file << "# Golden output hashes for GoldenOutputTest: scenario, samples, 64-bit FNV-1a hash\n";
+    file << "# Regenerate with GoldenOutputTest --update <this directory>, in a build with the same settings\n";
+    for (const Result& result : results) {
+        char hash[17];
+        snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)result.hash);
+        file << result.name << ' ' << result.numSamples << ' ' << hash << '\n';
+    }
+    return bool(file);
+}
+
+/// @brief Compare the results with a golden file
+/// @return Number of differences
+static unsigned compareGolden(const char* filename)
+{
+    std::ifstream file(filename);
+    if (!file) {
+        fprintf(stderr, "Can't read %s\n", filename);
+        return unsigned(results.size());
+    }
+    std::map<std::string, std::pair<unsigned, uint64_t>> golden;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name;
+        unsigned numSamples = 0;
+        uint64_t hash = 0;
+        fields >> name >> numSamples >> std::hex >> hash;
+        golden[name] = { numSamples, hash };
+    }
+    unsigned numDiffs = 0;
+    for (const Result& result : results) {
+        auto it = golden.find(result.name);
+        if (it == golden.end()) {
+            fprintf(stderr, "%s: no golden value\n", result.name.c_str());
+            ++numDiffs;
+        } else {
+            if (it->second != std::pair(result.numSamples, result.hash)) {
+                fprintf(stderr, "%s: output differs (%u samples, hash %016llx, golden %u samples, %016llx)\n",
+                    result.name.c_str(), result.numSamples, (unsigned long long)result.hash,
+                    it->second.first, (unsigned long long)it->second.second);
+                ++numDiffs;
+            }
+            golden.erase(it);
+        }
+    }
+    for (auto&& [name, value] : golden) {
+        fprintf(stderr, "%s: golden value for a scenario that no longer exists\n", name.c_str());
+        ++numDiffs;
+    }
+    return numDiffs;
+}
+
+int main(int argc, char* argv[])
+{
+    bool fUpdate = (argc == 3 && std::string_view(argv[1]) == "--update");
+    if (argc != 2 && !fUpdate) {
+        fputs("Usage: GoldenOutputTest [--update] <golden-dir>\n", stderr);
+        return EXIT_FAILURE;
+    }
+    const std::string pathname = std::string(argv[argc - 1]) + "/" + goldenFileName();
+    const char* filename = pathname.c_str();
+
+    Patches::init();
+    Defer::init();
+    Synth::init();
+    renderAll();
+
+    if (fUpdate) {
+        if (!writeGolden(filename)) {
+            fprintf(stderr, "Error writing %s\n", filename);
+            return EXIT_FAILURE;
+        }
+        printf("Wrote %zu golden values to %s\n", results.size(), filename);
+        return EXIT_SUCCESS;
+    }
+
+    unsigned numDiffs = compareGolden(filename);
+    if (numDiffs != 0) {
+        fprintf(stderr, "%u of %zu scenarios differ from %s\n"
+            "If the change to the sound is intended, run with --update and commit the file\n",
+            numDiffs, results.size(), filename);
+    }
+    CHECK(numDiffs == 0);
+    return TestUtils::result();
+}
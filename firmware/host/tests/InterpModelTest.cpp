@@ -0,0 +1,141 @@
+// InterpModelTest - Tests for the host model of the RP2040 interpolators and
+// for the WaveTable lookup that uses them
+
+#include "TestUtils.h"
+
+#include <numbers>
+#include <random>
+
+using namespace Dexy;
+
+/// @brief Shift, mask, sign extension and the full result
+static void testShiftMask()
+{
+    interp_config config = interp_default_config();
+    interp_config_set_shift(&config, 4);
+    interp_config_set_mask(&config, 0, 7);
+    interp_set_config(interp1, 0, &config);
+    interp_config_set_signed(&config, true);
+    interp_set_config(interp1, 1, &config);
+    interp_set_base(interp1, 0, 1000);
+    interp_set_base(interp1, 1, 1000);
+    interp_set_base(interp1, 2, 5);
+    interp_set_accumulator(interp1, 0, 0x12345);
+    interp_set_accumulator(interp1, 1, 0xABCDE);
+    CHECK(interp_peek_lane_result(interp1, 0) == 1000 + 0x34);
+    CHECK(interp_peek_lane_result(interp1, 1) == 1000 + 0xCD - 0x100);
+    CHECK(interp_peek_full_result(interp1) == 5 + 0x34 + 0xCD - 0x100);
+    // Peeking doesn't change the accumulators
+    CHECK(interp_get_accumulator(interp1, 0) == 0x12345);
+
+    // Default config passes the whole accumulator through
+    config = interp_default_config();
+    interp_set_config(interp1, 0, &config);
+    CHECK(interp_peek_lane_result(interp1, 0) == 1000 + 0x12345);
+}
+
+/// @brief Popping writes the results back, which accumulates with ADD_RAW
+/// and swaps with CROSS_RESULT
+static void testPop()
+{
+    interp_config config = interp_default_config();
+    interp_config_set_shift(&config, 8);
+    interp_config_set_add_raw(&config, true);
+    interp_set_config(interp1, 0, &config);
+    config = interp_default_config();
+    interp_config_set_cross_input(&config, true);
+    interp_set_config(interp1, 1, &config);
+    interp_set_base(interp1, 0, 3);
+    interp_set_base(interp1, 1, 0);
+    interp_set_accumulator(interp1, 0, 100);
+    interp_set_accumulator(interp1, 1, 0);
+    for (uint32_t i = 0; i < 10; ++i) {
+        CHECK(interp_peek_lane_result(interp1, 1) == 100 + 3 * i);
+        CHECK(interp_pop_lane_result(interp1, 0) == 100 + 3 * (i + 1));
+    }
+    CHECK(interp_get_accumulator(interp1, 1) == 100 + 3 * 9);
+
+    config = interp_default_config();
+    interp_config_set_cross_result(&config, true);
+    interp_set_config(interp1, 0, &config);
+    interp_set_config(interp1, 1, &config);
+    interp_set_base(interp1, 0, 0);
+    interp_set_base(interp1, 1, 0);
+    interp_set_accumulator(interp1, 0, 11);
+    interp_set_accumulator(interp1, 1, 22);
+    interp_pop_full_result(interp1);
+    CHECK(interp_get_accumulator(interp1, 0) == 22 && interp_get_accumulator(interp1, 1) == 11);
+}
+
+/// @brief Blend mode, signed and unsigned
+static void testBlend()
+{
+    interp_config config = interp_default_config();
+    interp_config_set_blend(&config, true);
+    interp_set_config(interp0, 0, &config);
+    config = interp_default_config();
+    interp_config_set_mask(&config, 0, 7);
+    interp_set_config(interp0, 1, &config);
+    interp_set_base(interp0, 0, 1000);
+    interp_set_base(interp0, 1, 2000);
+    interp_set_base(interp0, 2, 0);
+    interp_set_accumulator(interp0, 0, 7);
+    interp_set_accumulator(interp0, 1, 0x180);
+    CHECK(interp_peek_lane_result(interp0, 1) == 1500);
+    CHECK(interp_peek_full_result(interp0) == 7);
+    interp_set_base(interp0, 0, 2000);
+    interp_set_base(interp0, 1, 1000);
+    CHECK(interp_peek_lane_result(interp0, 1) == 1500);
+    interp_set_accumulator(interp0, 1, 0xFF);
+    CHECK(interp_peek_lane_result(interp0, 1) == 1000 + 3);
+    interp_config_set_signed(&config, true);
+    interp_set_config(interp0, 1, &config);
+    interp_set_base(interp0, 0, uint32_t(-1000));
+    interp_set_base(interp0, 1, 1000);
+    interp_set_accumulator(interp0, 1, 0xC0);
+    CHECK(interp_peek_lane_result(interp0, 1) == 500);
+}
+
+// Stand-in tables, the same as in SineWave.cpp and Envelope.cpp
+
+static constexpr output_t sineEntry(std::size_t index, std::size_t numValues)
+{
+    double phase = 2 * std::numbers::pi / (numValues-1) * index;
+    return output_t(std::round(std::sin(phase) * max_output_t));
+}
+
+static constexpr level_t attackEntry(std::size_t index, [[maybe_unused]] std::size_t numValues)
+{
+    return level_t(std::round(index * index * 0.2499962));
+}
+
+/// @brief Hardware lookups are the same as Blend8, bit for bit, including the
+/// phase update
+template<typename VALUE_T, VALUE_T FUNC_CALC1(std::size_t, std::size_t)>
+static void testLookup()
+{
+    using TableHw = WaveTable<VALUE_T, sizeLookupTable, FUNC_CALC1, Interpolate::Hardware>;
+    using TableSw = WaveTable<VALUE_T, sizeLookupTable, FUNC_CALC1, Interpolate::Blend8>;
+    Interpolate::Hardware::init<VALUE_T>();
+    std::mt19937 rng(2468);
+    for (unsigned i = 0; i < 100000; ++i) {
+        phase_t phaseHw = phase_t(rng());
+        phase_t phaseSw = phaseHw;
+        phase_t increment = phase_t(rng()) >> (rng() % 32);
+        modulation_t modulation = (i % 4 == 0) ? 0 : modulation_t(rng());
+        VALUE_T valueHw = TableHw::lookupInterpolate(&phaseHw, increment, modulation);
+        VALUE_T valueSw = TableSw::lookupInterpolate(&phaseSw, increment, modulation);
+        CHECK(valueHw == valueSw);
+        CHECK(phaseHw == phaseSw);
+    }
+}
+
+int main()
+{
+    testShiftMask();
+    testPop();
+    testBlend();
+    testLookup<output_t, sineEntry>();
+    testLookup<level_t, attackEntry>();
+    return TestUtils::result();
+}
@@ -0,0 +1,76 @@
+// InterpolateTest - Tests for the WaveTable interpolation policies
+
+#include "TestUtils.h"
+
+using namespace Dexy;
+
+/// @brief Number of fraction values between two table entries
+constexpr phase_t numFractions = phase_t(1) << cbitsLookupFraction;
+
+/// @brief Every policy gives the first entry at fraction 0 and stays between
+/// the two entries
+template<typename POLICY, typename VALUE_T>
+static void testBounds(VALUE_T entry0, VALUE_T entry1)
+{
+    VALUE_T lo = std::min(entry0, entry1);
+    VALUE_T hi = std::max(entry0, entry1);
+    CHECK(POLICY::interpolate(entry0, entry1, 0) == entry0);
+    for (phase_t fraction = 0; fraction < numFractions; ++fraction) {
+        VALUE_T value = POLICY::interpolate(entry0, entry1, fraction);
+        CHECK(value >= lo && value <= hi);
+    }
+}
+
+/// @brief Average3 is the same as the original hard-coded interpolation
+template<typename VALUE_T>
+static void testAverage3(VALUE_T entry0, VALUE_T entry1)
+{
+    for (phase_t phase = 0; phase < numFractions; phase += 0x100) {
+        VALUE_T value = entry0;
+        value = VALUE_T((value + ((phase & 0x1000) ? entry1 : entry0)) / 2);
+        value = VALUE_T((value + ((phase & 0x2000) ? entry1 : entry0)) / 2);
+        value = VALUE_T((value + ((phase & 0x4000) ? entry1 : entry0)) / 2);
+        CHECK(Interpolate::Average3::interpolate(entry0, entry1, phase) == value);
+    }
+}
+
+/// @brief Linear interpolation is monotonic and exact at the midpoint
+template<typename VALUE_T>
+static void testLinear(VALUE_T entry0, VALUE_T entry1)
+{
+    VALUE_T prev = entry0;
+    for (phase_t fraction = 1; fraction < numFractions; ++fraction) {
+        VALUE_T value = Interpolate::Linear::interpolate(entry0, entry1, fraction);
+        CHECK(entry1 >= entry0 ? value >= prev : value <= prev);
+        prev = value;
+    }
+    int32_t mid = (int32_t(entry0) + int32_t(entry1));
+    if (mid % 2 == 0) {
+        CHECK(Interpolate::Linear::interpolate(entry0, entry1, numFractions / 2) == mid / 2);
+    }
+}
+
+template<typename VALUE_T>
+static void testAll(VALUE_T entry0, VALUE_T entry1)
+{
+    testBounds<Interpolate::Nearest>(entry0, entry1);
+    testBounds<Interpolate::Average3>(entry0, entry1);
+    testBounds<Interpolate::Linear>(entry0, entry1);
+    testBounds<Interpolate::Blend8>(entry0, entry1);
+    testAverage3(entry0, entry1);
+    testLinear(entry0, entry1);
+}
+
+int main()
+{
+    // Unsigned (envelope) and signed (sine) tables, full-scale differences
+    testAll<level_t>(0, max_level_t);
+    testAll<level_t>(max_level_t, 0);
+    testAll<level_t>(1000, 1003);
+    testAll<output_t>(-max_output_t, max_output_t);
+    testAll<output_t>(max_output_t, -max_output_t);
+    testAll<output_t>(-5, -2);
+    CHECK(Interpolate::Nearest::interpolate<level_t>(10, 20, numFractions / 2 - 1) == 10);
+    CHECK(Interpolate::Nearest::interpolate<level_t>(10, 20, numFractions / 2) == 20);
+    return TestUtils::result();
+}
@@ -0,0 +1,64 @@
+// MidiNoteTest - Compare SineWave::getIncrementForMidiNoteFast() with a
+// double-precision calculation, for every midiNote_t value
+
+#include "TestUtils.h"
+
+using namespace Dexy;
+
+/// @brief Exact wavetable increment for a note
+static double incrementExact(midiNote_t note)
+{
+    double freqHz = 440.0 * std::pow(2.0, (double(note) / midiNoteSemitone - 69.0) / 12.0);
+    return freqHz * (1 << cbitsPhase) / SineWave::freqSample;
+}
+
+static void testAllNotes()
+{
+    double maxErrorLsb = 0;
+    double maxErrorCents = 0;
+    phase_t incrementPrev = 0;
+    bool fMonotonic = true;
+    for (int note = std::numeric_limits<midiNote_t>::min();
+        note <= std::numeric_limits<midiNote_t>::max(); ++note)
+    {
+        phase_t increment = SineWave::getIncrementForMidiNoteFast(midiNote_t(note));
+        double exact = incrementExact(midiNote_t(note));
+        // Allowed error: rounding to an integer plus 1e-5 for interpolation
+        double error = std::abs(double(increment) - exact);
+        if (error > 0.5 + exact * 1e-5) {
+            fprintf(stderr, "note %d: increment %u, exact %.3f\n", note, increment, exact);
+            CHECK(false);
+        }
+        maxErrorLsb = std::max(maxErrorLsb, error);
+        // Error in cents, only meaningful where rounding doesn't dominate
+        if (exact >= 100000) {
+            maxErrorCents = std::max(maxErrorCents, std::abs(1200.0 * std::log2(increment / exact)));
+        }
+        fMonotonic = fMonotonic && (increment >= incrementPrev);
+        incrementPrev = increment;
+    }
+    printf("Max error: %.2f LSB, %.4f cents\n", maxErrorLsb, maxErrorCents);
+    CHECK(maxErrorCents < 0.02);
+    CHECK(fMonotonic);
+}
+
+/// @brief Some well-known values
+static void testNotes()
+{
+    // A4 = 440 Hz
+    CHECK(std::abs(double(SineWave::getIncrementForMidiNoteFast(69 * midiNoteSemitone))
+        - SineWave::getIncrementForHz(440.0)) <= 1);
+    // Octaves are exactly double
+    for (int note = -100; note < 100; note += 7) {
+        phase_t lower = SineWave::getIncrementForMidiNoteFast(midiNote_t(note * midiNoteSemitone));
+        phase_t upper = SineWave::getIncrementForMidiNoteFast(midiNote_t((note + 12) * midiNoteSemitone));
+        CHECK(upper >= 2 * lower - 1 && upper <= 2 * lower + 1);
+    }
+}
+
+int main()
+{
+    testAllNotes();
+    testNotes();
+    return TestUtils::result();
+}
@@ -0,0 +1,79 @@
+// PitchUpdateTest - Tests for the 32-bit pitch scaling in Operator and for
+// Hysteresis
+
+#include "TestUtils.h"
+
+#include <random>
+
+using namespace Dexy;
+
+/// @brief Reference: the original 64-bit calculation
+static phase_t scalePitch64(phase_t pitch, freqRatio_t ratio)
+{
+    return phase_t((uint64_t(pitch) * uint64_t(ratio)) >> 11);
+}
+
+/// @brief Operator::scalePitch() must match the 64-bit calculation exactly
+static void testScalePitch()
+{
+    static_assert(Operator::scalePitch(12345678, freqRatio1) == 12345678);
+    static_assert(Operator::scalePitch(1000, 2 * freqRatio1) == 2000);
+
+    std::mt19937 rng(1234);
+    unsigned numMismatches = 0;
+    for (unsigned ratio = 0; ratio <= std::numeric_limits<freqRatio_t>::max(); ++ratio) {
+        // Extreme values plus random pitches of all sizes
+        for (phase_t pitch : { 0u, 1u, 0xFFFu, 0x1000u, 0xFFFFFFu, 0xFFFFFFFFu }) {
+            numMismatches += (Operator::scalePitch(pitch, freqRatio_t(ratio))
+                != scalePitch64(pitch, freqRatio_t(ratio)));
+        }
+        for (int i = 0; i < 32; ++i) {
+            phase_t pitch = phase_t(rng()) >> (rng() % 32);
+            numMismatches += (Operator::scalePitch(pitch, freqRatio_t(ratio))
+                != scalePitch64(pitch, freqRatio_t(ratio)));
+        }
+    }
+    CHECK(numMismatches == 0);
+}
+
+/// @brief Hysteresis follows changes in one direction and ignores small reversals
+static void testHysteresis()
+{
+    Hysteresis<uint16_t, 2> value(std::numeric_limits<uint16_t>::max());
+    CHECK(value.update(100));       // falling from the initial value
+    CHECK(value.get() == 100);
+    CHECK(value.update(99));        // still falling
+    CHECK(!value.update(100));      // small reversals
+    CHECK(!value.update(101));
+    CHECK(!value.update(99));
+    CHECK(value.get() == 99);
+    CHECK(value.update(102));       // large reversal
+    CHECK(value.update(103));       // still rising, one unit at a time
+    CHECK(value.update(104));
+    CHECK(!value.update(102));
+    CHECK(value.get() == 104);
+    CHECK(value.update(0));
+    CHECK(!value.update(1));
+    CHECK(value.get() == 0);
+
+    // Noise of +/-1 around a steady value causes at most a couple of updates
+    Hysteresis<uint16_t, 2> noisy(std::numeric_limits<uint16_t>::max());
+    unsigned numUpdates = 0;
+    for (int i = 0; i < 1000; ++i) {
+        numUpdates += noisy.update(uint16_t(500 + (i * 7) % 3 - 1));
+    }
+    CHECK(numUpdates <= 2);
+
+    Hysteresis<uint16_t, 0> exact;
+    CHECK(!exact.update(0));
+    CHECK(exact.update(1));
+    CHECK(exact.update(0));
+    CHECK(!exact.update(0));
+}
+
+int main()
+{
+    testScalePitch();
+    testHysteresis();
+    return TestUtils::result();
+}
@@ -0,0 +1,77 @@
+// QuarterWaveTest - Tests for QuarterWaveTable
+
+#include "TestUtils.h"
+
+#include <numbers>
+#include <random>
+
+using namespace Dexy;
+
+// Stand-ins for the sine tables in SineWave.cpp
+
+static constexpr output_t sineEntry(std::size_t index, std::size_t numValues)
+{
+    double phase = 2 * std::numbers::pi / (numValues-1) * index;
+    return output_t(std::round(std::sin(phase) * max_output_t));
+}
+
+static constexpr output_t quarterSineEntry(std::size_t index, std::size_t numValues)
+{
+    double phase = std::numbers::pi / 2 / (numValues-1) * index;
+    return output_t(std::round(std::sin(phase) * max_output_t));
+}
+
+/// @brief A quarter-wave table gives the same results as a full table of
+/// the same resolution, including the phase update
+template<typename INTERPOLATE>
+static void testSameAsFull()
+{
+    using Full = WaveTable<output_t, sizeLookupTable, sineEntry, INTERPOLATE>;
+    using Quarter = QuarterWaveTable<output_t, cbitsLookupIndex - 2, quarterSineEntry, INTERPOLATE>;
+    std::mt19937 rng(97531);
+    for (unsigned i = 0; i < 100000; ++i) {
+        phase_t phaseFull = phase_t(rng());
+        phase_t phaseQuarter = phaseFull;
+        phase_t increment = phase_t(rng()) >> (rng() % 32);
+        modulation_t modulation = (i % 4 == 0) ? 0 : modulation_t(rng());
+        CHECK(Full::lookupInterpolate(&phaseFull, increment, modulation)
+            == Quarter::lookupInterpolate(&phaseQuarter, increment, modulation));
+        CHECK(phaseFull == phaseQuarter);
+    }
+    // Every table entry, in every quarter
+    for (phase_t phase = 0; phase < (phase_t(1) << cbitsPhase); phase += phase_t(1) << cbitsLookupFraction) {
+        phase_t phaseFull = phase;
+        phase_t phaseQuarter = phase;
+        CHECK(Full::lookupInterpolate(&phaseFull, 0) == Quarter::lookupInterpolate(&phaseQuarter, 0));
+    }
+}
+
+/// @brief A quarter-wave table with the same memory has 4 times the
+/// resolution, so it's closer to the ideal sine wave
+static void testResolution()
+{
+    using Full = WaveTable<output_t, sizeLookupTable, sineEntry, Interpolate::Nearest>;
+    using Quarter = QuarterWaveTable<output_t, cbitsLookupIndex, quarterSineEntry, Interpolate::Nearest>;
+    static_assert(Quarter::numValues == sizeLookupTable);
+    double maxErrorFull = 0;
+    double maxErrorQuarter = 0;
+    for (phase_t phase = 0; phase < (phase_t(1) << cbitsPhase); phase += 0x1001) {
+        double ideal = std::sin(2 * std::numbers::pi * phase / (phase_t(1) << cbitsPhase)) * max_output_t;
+        phase_t p = phase;
+        maxErrorFull = std::max(maxErrorFull, std::abs(Full::lookupInterpolate(&p, 0) - ideal));
+        p = phase;
+        maxErrorQuarter = std::max(maxErrorQuarter, std::abs(Quarter::lookupInterpolate(&p, 0) - ideal));
+    }
+    // The error of the nearest entry is proportional to the entry spacing
+    CHECK(maxErrorQuarter < maxErrorFull / 3);
+}
+
+int main()
+{
+    testSameAsFull<Interpolate::Nearest>();
+    testSameAsFull<Interpolate::Average3>();
+    testSameAsFull<Interpolate::Linear>();
+    testSameAsFull<Interpolate::Blend8>();
+    testResolution();
+    return TestUtils::result();
+}
@@ -0,0 +1,166 @@
+// ReferenceVoiceTest - Tests for the double-precision reference voice: it must
+// agree with the engine closely enough to be a useful yardstick, so that
+// DexyCompare measures the engine's approximations and not differences in
+// behaviour
+
+#include "TestUtils.h"
+#include "DexyReference.h"
+
+#include <vector>
+
+using namespace Dexy;
+using namespace Dexy::Synth;
+
+/// @brief Samples per block, the same as Core1
+constexpr unsigned blockSize = 8;
+
+/// @brief Relative accuracy of the engine's rate and level tables (expRateMap
+/// and expLevelMap)
+constexpr double tableTolerance = 0.001;
+
+/// @brief Level difference allowed for the engine's interpolated envelope
+/// tables, in level_t units
+constexpr double levelTolerance = 32;
+
+/// @brief Difference allowed in the time that the release stage takes, in
+/// samples, for the rounding of the tables that map levels to progress
+constexpr int idleTolerance = 16;
+
+/// @brief Check that each reference level is within the range of the engine's
+/// levels around the same time, allowing for the rate table's accuracy
+/// @return Maximum difference outside the range
+static double checkLevels(const std::vector<level_t>& levelsEngine, const std::vector<double>& levelsRef)
+{
+    double diff = TestUtils::maxOutsideWindow<level_t, double>(levelsEngine, levelsRef, [](std::size_t i) {
+        return 4 + std::size_t(double(i) * tableTolerance);
+    });
+    CHECK(diff <= levelTolerance);
+    return diff;
+}
+
+/// @brief The reference envelope follows the engine's envelope through every
+/// stage and goes idle at the same time
+static void testEnvelope()
+{
+    double maxDiff = 0;
+    TestUtils::forEachEnvParams([&](const Patches::EnvParams& params) {
+        Envelope env;
+        env.setSettings(Envelope::makeSettings(params));
+        Reference::Envelope ref;
+        ref.setParams(params);
+        std::vector<level_t> levelsEngine;
+        std::vector<double> levelsRef;
+
+        // Hold for a second, long enough to reach the sustain level
+        env.gateStart();
+        ref.gateStart();
+        for (unsigned i = 0; i < SineWave::freqSample; ++i) {
+            levelsEngine.push_back(env.genNextOutputExact());
+            levelsRef.push_back(ref.genNextOutput());
+        }
+        maxDiff = std::max(maxDiff, checkLevels(levelsEngine, levelsRef));
+        CHECK(std::abs(ref.getLevel() - env.getLevel()) <= 1 + env.getLevel() * tableTolerance);
+
+        // Release until both are idle
+        levelsEngine.clear();
+        levelsRef.clear();
+        env.gateStop();
+        ref.gateStop();
+        unsigned iIdleEngine = 0;
+        unsigned iIdleRef = 0;
+        for (unsigned i = 1; i < 4 * SineWave::freqSample && !(iIdleEngine && iIdleRef); ++i) {
+            levelsEngine.push_back(env.genNextOutputExact());
+            levelsRef.push_back(ref.genNextOutput());
+            iIdleEngine = (!iIdleEngine && env.isIdle()) ? i : iIdleEngine;
+            iIdleRef = (!iIdleRef && ref.isIdle()) ? i : iIdleRef;
+        }
+        CHECK(iIdleEngine != 0 && iIdleRef != 0);
+        CHECK(std::abs(int(iIdleEngine) - int(iIdleRef)) <= idleTolerance);
+        maxDiff = std::max(maxDiff, checkLevels(levelsEngine, levelsRef));
+    });
+    printf("Envelope: max difference %.1f\n", maxDiff);
+}
+
+/// @brief Signal to error ratio in dB of a note played by the engine, with the
+/// reference voice as the signal
+static double measureSnr(const Patches::Patch& patch)
+{
+    constexpr unsigned numHold = SineWave::freqSample / 2;
+    constexpr unsigned numRelease = SineWave::freqSample / 2;
+    const phase_t pitch = SineWave::getIncrementForHz(220.0);
+    static Voice voice;
+    voice = Voice();
+    voice.setSettings(Voice::makeSettings(patch));
+    voice.setNotePitch(pitch);
+    Reference::Voice ref;
+    ref.setPatch(patch);
+    ref.setNotePitch(pitch);
+
+    double signal = 0;
+    double error = 0;
+    auto run = [&](unsigned numSamples) {
+        for (unsigned i = 0; i < numSamples; i += blockSize) {
+            std::array<output_t, blockSize> outputs;
+            std::array<double, blockSize> outputsRef;
+            voice.genNextBlock(outputs, 0);
+            ref.genNextBlock(outputsRef, 0);
+            for (auto&& [output, outputRef] : std::views::zip(outputs, outputsRef)) {
+                signal += outputRef * outputRef;
+                error += (output - outputRef) * (output - outputRef);
+            }
+        }
+    };
+    voice.gateStart();
+    ref.gateStart();
+    run(numHold);
+    voice.gateStop();
+    ref.gateStop();
+    run(numRelease);
+    return 10 * std::log10(signal / error);
+}
+
+/// @brief The engine's output matches the reference's for every algorithm and
+/// the shipped patches, within the accuracy of its tables
+/// @details The thresholds are below the default build's results with some
+/// room for the optional settings in CompileDefs.h. A big drop means that the
+/// reference has stopped following the engine (or the engine has got a lot
+/// worse): check with DexyCompare.
+static void testVoice()
+{
+    // A single sine wave: only the sine table's accuracy
+    Patches::Patch patch = Patches::makeTestPatch();
+    for (auto&& [iOp, op] : std::views::enumerate(patch.opParams)) {
+        op.outputLevel = (iOp == 0) ? max_param_t : 0;
+    }
+    double snr = measureSnr(patch);
+    printf("Sine: SNR %.1f dB\n", snr);
+    CHECK(snr > 50);
+
+    double minSnr = INFINITY;
+    for (unsigned iAlgo = 0; iAlgo < numAlgorithms; ++iAlgo) {
+        patch = Patches::makeDefaultPatch();
+        patch.algorithm = uint8_t(iAlgo);
+        snr = measureSnr(patch);
+        CHECK(snr > 40);
+        minSnr = std::min(minSnr, snr);
+    }
+    printf("Algorithms: min SNR %.1f dB\n", minSnr);
+
+    minSnr = INFINITY;
+    for (unsigned iPatch = 0; iPatch < Patches::numPatches; ++iPatch) {
+        snr = measureSnr(Patches::getPatch(iPatch));
+        CHECK(snr > 30);
+        minSnr = std::min(minSnr, snr);
+    }
+    printf("Patch bank: min SNR %.1f dB\n", minSnr);
+}
+
+int main()
+{
+    Patches::init();
+    SineWave::init();
+    Envelope::init();
+    testEnvelope();
+    testVoice();
+    return TestUtils::result();
+}
@@ -0,0 +1,104 @@
+// RingBufferTest - Tests for RingBuffer, including a simulated DAC timer
+// interrupt running in another thread
+
+#include "TestUtils.h"
+
+#include <thread>
+
+using namespace Dexy;
+
+/// @brief Basic push/pop behaviour in a single thread
+static void testSingleThread()
+{
+    RingBuffer<uint16_t, 8> buffer;
+    uint16_t value = 0;
+    CHECK(buffer.isEmpty());
+    CHECK(!buffer.pop(&value));
+    CHECK(buffer.getLowWaterMark() == 0);
+
+    buffer.resetLowWaterMark();
+    CHECK(buffer.getLowWaterMark() == 8);
+    for (uint16_t i = 0; i < 8; ++i) {
+        CHECK(buffer.push(i));
+    }
+    CHECK(buffer.isFull());
+    CHECK(!buffer.push(99));
+    for (uint16_t i = 0; i < 8; ++i) {
+        CHECK(buffer.pop(&value));
+        CHECK(value == i);
+    }
+    CHECK(buffer.isEmpty());
+    // The consumer found 8, 7, ... 1 entries
+    CHECK(buffer.getLowWaterMark() == 1);
+
+    // Wrap around many times, keeping 3 entries in the buffer
+    buffer.resetLowWaterMark();
+    uint16_t next = 0;
+    uint16_t expected = 0;
+    for (int i = 0; i < 3; ++i) {
+        CHECK(buffer.push(next++));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(buffer.push(next++));
+        CHECK(buffer.pop(&value));
+        CHECK(value == expected++);
+    }
+    CHECK(buffer.count() == 3);
+    CHECK(buffer.getLowWaterMark() == 4);
+}
+
+/// @brief A producer renders blocks of samples and a consumer thread takes
+/// them at a fixed rate, like Core1::synthLoop() and SpiDac::onOutputTimer().
+static void testProducerConsumer()
+{
+    constexpr unsigned numValues = 200'000;
+    constexpr unsigned blockSize = 8;
+    static RingBuffer<uint32_t, 32> buffer;
+
+    // Consumer: the simulated timer interrupt
+    unsigned numLate = 0;
+    unsigned numReceived = 0;
+    bool fInOrder = true;
+    std::thread consumer([&] {
+        uint32_t expected = 0;
+        while (expected < numValues) {
+            uint32_t value;
+            if (buffer.pop(&value)) {
+                fInOrder = fInOrder && (value == expected);
+                ++expected;
+                ++numReceived;
+            } else {
+                ++numLate;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // Producer: the synth loop, which sometimes stalls as if loading a patch
+    uint32_t next = 0;
+    while (next < numValues) {
+        for (unsigned i = 0; i < blockSize && next < numValues; ++i) {
+            while (!buffer.push(next)) {
+                std::this_thread::yield();
+            }
+            ++next;
+        }
+        if (next % 10'000 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+
+    CHECK(fInOrder);
+    CHECK(numReceived == numValues);
+    CHECK(buffer.isEmpty());
+    // The low-water mark must show any time the consumer found the buffer empty
+    CHECK((numLate == 0) == (buffer.getLowWaterMark() != 0));
+}
+
+int main()
+{
+    testSingleThread();
+    testProducerConsumer();
+    return TestUtils::result();
+}
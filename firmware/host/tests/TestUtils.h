@@ -0,0 +1,99 @@
+// TestUtils - Minimal helpers for the host unit tests
+
+#pragma once
+
+#include "DexyCore.h"
+
+#include <cstdlib>
+
+namespace Dexy { namespace TestUtils {
+
+/// @brief Number of failed checks so far
+inline unsigned numFailures = 0;
+
+/// @brief Record a failed check
+inline void fail(const char* file, int line, const char* expr)
+{
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expr);
+    ++numFailures;
+}
+
+/// @brief Program exit code based on whether any checks failed
+inline int result()
+{
+    if (numFailures != 0) {
+        fprintf(stderr, "%u check(s) failed\n", numFailures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/// @brief Envelope rates to test - from slow to instantaneous
+constexpr param_t envTestRates[] = { 500, 700, 850, 950, max_param_t };
+
+/// @brief Envelope sustain levels to test
+constexpr param_t envTestSustains[] = { 0, 700, max_param_t };
+
+/// @brief Envelope delays to test
+constexpr param_t envTestDelays[] = { 0, 300 };
+
+/// @brief Envelope settings to test with forEachEnvParams()
+struct EnvSweep
+{
+    std::span<const param_t> rates = envTestRates;          ///< Attack, decay and release rates
+    std::span<const param_t> sustains = envTestSustains;    ///< Sustain levels
+    std::span<const param_t> delays = envTestDelays;        ///< Delays
+    bool fLoop = false;                                     ///< Also test looping envelopes
+};
+
+/// @brief Call a function with every combination of the envelope settings
+/// @param fn Function taking a const Patches::EnvParams&
+template<typename FN>
+void forEachEnvParams(FN fn, const EnvSweep& sweep = {})
+{
+    for (param_t attack : sweep.rates) {
+        for (param_t decay : sweep.rates) {
+            for (param_t release : sweep.rates) {
+                for (param_t sustain : sweep.sustains) {
+                    for (param_t delay : sweep.delays) {
+                        for (bool loop : { false, true }) {
+                            if (loop && !sweep.fLoop) {
+                                break;
+                            }
+                            fn(Patches::EnvParams{
+                                .delay = delay, .attack = attack, .decay = decay,
+                                .sustain = sustain, .release = release, .loop = loop });
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief How far values stray outside the range of the expected values
+/// around the same time
+/// @details Each actual[i] is compared with the minimum and maximum of
+/// expected[i - window(i)] to expected[i + window(i)].
+/// @param window Function giving the number of samples either side of i
+/// @return Largest distance of an actual value outside its range, 0 if all
+/// are within range
+template<typename EXPECTED, typename ACTUAL, typename WINDOW>
+double maxOutsideWindow(std::span<const EXPECTED> expected, std::span<const ACTUAL> actual, WINDOW window)
+{
+    double maxDiff = 0;
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+        std::size_t size = window(i);
+        std::size_t iFirst = (i >= size) ? i - size : 0;
+        std::size_t iLast = std::min(i + size, expected.size() - 1);
+        auto [itMin, itMax] = std::minmax_element(expected.begin() + iFirst, expected.begin() + iLast + 1);
+        maxDiff = std::max({ maxDiff, double(*itMin) - double(actual[i]), double(actual[i]) - double(*itMax) });
+    }
+    return maxDiff;
+}
+
+} } // namespace TestUtils
+
+/// @brief Check that a condition is true; report it and carry on if not
+#define CHECK(cond) \
+    do { if (!(cond)) Dexy::TestUtils::fail(__FILE__, __LINE__, #cond); } while (false)
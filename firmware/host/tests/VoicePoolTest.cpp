@@ -0,0 +1,127 @@
+// VoicePoolTest - Tests for voice allocation & stealing in Synth::VoicePool,
+// and mixing the voices' outputs
+
+#include "TestUtils.h"
+
+using namespace Dexy;
+using namespace Dexy::Synth;
+
+/// @brief Settings for the patch used by all the tests
+static Voice::Settings settings;
+
+static const phase_t pitchA = SineWave::getIncrementForHz(220.0);
+static const phase_t pitchB = SineWave::getIncrementForHz(330.0);
+static const phase_t pitchC = SineWave::getIncrementForHz(440.0);
+
+/// @brief Render some samples and throw them away
+template<unsigned NUM_VOICES>
+static void render(VoicePool<NUM_VOICES>& pool, unsigned numSamples)
+{
+    std::array<output_t, 64> buf;
+    for (unsigned i = 0; i < numSamples; i += unsigned(buf.size())) {
+        pool.genNextBlock(buf, 0);
+    }
+}
+
+/// @brief Free voices are used before any are stolen
+static void testFreeVoices()
+{
+    VoicePool<3> pool;
+    pool.setSettings(settings);
+    CHECK(!pool.isSounding(0) && !pool.isSounding(1) && !pool.isSounding(2));
+    CHECK(pool.noteOn(pitchA) == 0);
+    CHECK(pool.noteOn(pitchB) == 1);
+    CHECK(pool.isSounding(0) && pool.isSounding(1) && !pool.isSounding(2));
+    // A released voice isn't free until its release has finished
+    pool.noteOff(pitchA);
+    CHECK(pool.isSounding(0));
+    CHECK(pool.noteOn(pitchC) == 2);
+}
+
+/// @brief StealPolicy::oldest steals the voice whose note started first
+static void testStealOldest()
+{
+    VoicePool<2> pool(StealPolicy::oldest);
+    pool.setSettings(settings);
+    pool.noteOn(pitchA);
+    pool.noteOn(pitchB);
+    pool.noteOff(pitchB);
+    CHECK(pool.noteOn(pitchC) == 0);
+    CHECK(pool.noteOn(pitchA) == 1);
+}
+
+/// @brief StealPolicy::releasedFirst prefers a released voice, even if it
+/// started after one that is still held
+static void testStealReleasedFirst()
+{
+    VoicePool<2> pool(StealPolicy::releasedFirst);
+    pool.setSettings(settings);
+    pool.noteOn(pitchA);
+    pool.noteOn(pitchB);
+    pool.noteOff(pitchB);
+    CHECK(pool.noteOn(pitchC) == 1);
+    // With none released it falls back to the oldest
+    CHECK(pool.noteOn(pitchB) == 0);
+}
+
+/// @brief StealPolicy::quietest steals the voice with the lowest level
+static void testStealQuietest()
+{
+    VoicePool<2> pool(StealPolicy::quietest);
+    pool.setSettings(settings);
+    pool.noteOn(pitchA);
+    render(pool, 4096);
+    // Voice 1's envelopes have only just started, so it is quieter
+    pool.noteOn(pitchB);
+    CHECK(pool[1].getLevel() < pool[0].getLevel());
+    CHECK(pool.noteOn(pitchC) == 1);
+}
+
+/// @brief One voice in a pool sounds the same as a Voice on its own, and the
+/// voices' outputs are added together
+static void testMix()
+{
+    Voice voice;
+    voice.setSettings(settings);
+    voice.setNotePitch(pitchA);
+    voice.gateStart();
+    VoicePool<1> pool1;
+    pool1.setSettings(settings);
+    pool1.noteOn(pitchA);
+    VoicePool<2> pool2;
+    pool2.setSettings(settings);
+    pool2.noteOn(pitchA);
+    pool2.noteOn(pitchA);
+
+    constexpr unsigned numSamples = 1000;
+    std::array<output_t, numSamples> outVoice, out1, out2;
+    voice.genNextBlock(outVoice, 0);
+    pool1.genNextBlock(out1, 0);
+    pool2.genNextBlock(out2, 0);
+    CHECK(out1 == outVoice);
+    unsigned numMismatches = 0;
+    for (unsigned i = 0; i < numSamples; ++i) {
+        int32_t expected = std::clamp(2 * int32_t(outVoice[i]), int32_t(INT16_MIN), int32_t(INT16_MAX));
+        numMismatches += (out2[i] != expected);
+    }
+    CHECK(numMismatches == 0);
+
+    // noteOff stops both voices that are playing the note
+    pool2.noteOff(pitchA);
+    CHECK(pool2.noteOn(pitchB) == 0);
+}
+
+int main()
+{
+    Patches::init();
+    SineWave::init();
+    Envelope::init();
+    settings = Voice::makeSettings(Patches::getPatch(0));
+
+    testFreeVoices();
+    testStealOldest();
+    testStealReleasedFirst();
+    testStealQuietest();
+    testMix();
+    return TestUtils::result();
+}
@@ -0,0 +1,237 @@
+// DexyCompare - Accuracy of the synth engine against the reference voice
+//
+// Plays one note with a patch through both the fixed-point engine
+// (Synth::Voice) and the double-precision reference (Reference::Voice in
+// ReferenceVoice.h), and reports how far the engine's output is from the
+// reference:
+//   SNR       Signal to error ratio over the whole note, in dB
+//   max err   Largest difference of one sample, in output_t units, and when
+//   spectrum  RMS difference of the two long-term spectra, in dB, over the
+//             bins within 80 dB of the reference's peak
+//
+// Use this to see what an optimization costs in accuracy, or to check that a
+// change to the engine stays faithful to the formulas it's built from. The
+// reference has no tables, so the numbers include all of the engine's
+// approximations (table lookups, fixed-point rounding, envelope rate tables).
+//
+// Usage: DexyCompare [options]
+//   -b bank.dexy  Patch bank (default: the built-in default.dexy)
+//   -p n          Compare only patch n (0-based)
+//   -n note       MIDI note (default 57, A3)
+//   -t seconds    Time the note is held (default 1)
+//   -r seconds    Time after the note is released (default 1)
+//   -m timbre     Timbre modulation, -1 to 1 (default 0)
+
+#include "DexyReference.h"
+#include "ToolUtils.h"
+
+#include <complex>
+#include <vector>
+
+using namespace Dexy;
+using namespace Dexy::Synth;
+using namespace Dexy::ToolUtils;
+
+/// @brief Samples per block, the same as Core1
+constexpr unsigned blockSize = 8;
+
+/// @brief FFT size for the spectrum comparison
+constexpr unsigned fftSize = 4096;
+
+/// @brief Range of the spectrum that is compared, below the reference's peak
+constexpr double spectrumRangeDb = 80.0;
+
+/// @brief Settings from the command line
+struct Options
+{
+    const char* bankFile = nullptr;
+    int iPatch = -1;
+    unsigned note = 57;
+    double holdTime = 1.0;
+    double releaseTime = 1.0;
+    double timbre = 0.0;
+};
+
+/// @brief Accuracy of one patch
+struct Comparison
+{
+    double snrDb = 0;           ///< Signal to error ratio (infinite if no error)
+    double maxError = 0;        ///< Largest error of a single sample
+    double maxErrorTime = 0;    ///< Time of maxError, in seconds
+    double spectrumDb = 0;      ///< RMS log-spectral distance
+};
+
+/// @brief In-place radix-2 FFT
+/// @param data Samples, a power of 2 of them
+static void fft(std::span<std::complex<double>> data)
+{
+    const std::size_t n = data.size();
+    for (std::size_t i = 1, j = 0; i < n; ++i) {
+        std::size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        std::complex<double> w = std::polar(1.0, -2 * std::numbers::pi / double(len));
+        for (std::size_t i = 0; i < n; i += len) {
+            std::complex<double> wk = 1.0;
+            for (std::size_t k = 0; k < len / 2; ++k) {
+                std::complex<double> u = data[i + k];
+                std::complex<double> v = data[i + k + len / 2] * wk;
+                data[i + k] = u + v;
+                data[i + k + len / 2] = u - v;
+                wk *= w;
+            }
+        }
+    }
+}
+
+/// @brief Long-term power spectrum: the average over Hann-windowed frames
+/// that overlap by half
+/// @param samples
+/// @return Power of each bin from 0 to fftSize / 2
+static std::vector<double> powerSpectrum(std::span<const double> samples)
+{
+    std::vector<double> power(fftSize / 2 + 1, 0.0);
+    std::vector<std::complex<double>> frame(fftSize);
+    for (std::size_t start = 0; start + fftSize <= samples.size(); start += fftSize / 2) {
+        for (unsigned i = 0; i < fftSize; ++i) {
+            double window = 0.5 - 0.5 * std::cos(2 * std::numbers::pi * i / fftSize);
+            frame[i] = samples[start + i] * window;
+        }
+        fft(frame);
+        for (unsigned i = 0; i < power.size(); ++i) {
+            power[i] += std::norm(frame[i]);
+        }
+    }
+    return power;
+}
+
+/// @brief Compare the engine's output with the reference
+static Comparison compare(std::span<const double> engine, std::span<const double> reference)
+{
+    Comparison result;
+    double signal = 0;
+    double error = 0;
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        double diff = engine[i] - reference[i];
+        signal += reference[i] * reference[i];
+        error += diff * diff;
+        if (std::abs(diff) > result.maxError) {
+            result.maxError = std::abs(diff);
+            result.maxErrorTime = double(i) / SineWave::freqSample;
+        }
+    }
+    result.snrDb = (error > 0) ? 10 * std::log10(signal / error) : INFINITY;
+
+    std::vector<double> powerEngine = powerSpectrum(engine);
+    std::vector<double> powerRef = powerSpectrum(reference);
+    double peak = std::ranges::max(powerRef);
+    double floor = peak * std::pow(10.0, -spectrumRangeDb / 10);
+    double total = 0;
+    unsigned numBins = 0;
+    for (std::size_t i = 0; i < powerRef.size(); ++i) {
+        if (powerRef[i] > floor && peak > 0) {
+            double db = 10 * std::log10(std::max(powerEngine[i], floor) / powerRef[i]);
+            total += db * db;
+            ++numBins;
+        }
+    }
+    result.spectrumDb = (numBins > 0) ? std::sqrt(total / numBins) : 0;
+    return result;
+}
+
+/// @brief Play a note with a patch through the engine and the reference
+static Comparison comparePatch(const Patches::Patch& patch, const Options& options)
+{
+    const auto numHold = unsigned(options.holdTime * SineWave::freqSample) / blockSize * blockSize;
+    const auto numRelease = unsigned(options.releaseTime * SineWave::freqSample) / blockSize * blockSize;
+    const phase_t pitch = SineWave::getIncrementForMidiNoteFast(midiNote_t(options.note * midiNoteSemitone));
+    const auto timbreMod = output_t(std::lround(options.timbre * INT16_MAX));
+
+    // Voices are big, so they don't go on the stack
+    auto voice = std::make_unique<Voice>();
+    voice->setSettings(Voice::makeSettings(patch));
+    voice->setNotePitch(pitch);
+    auto reference = std::make_unique<Reference::Voice>();
+    reference->setPatch(patch);
+    reference->setNotePitch(pitch);
+
+    std::vector<double> outputsEngine;
+    std::vector<double> outputsRef(numHold + numRelease);
+    std::span<double> outputsRefLeft(outputsRef);
+    auto run = [&](unsigned numSamples) {
+        for (unsigned i = 0; i < numSamples; i += blockSize) {
+            std::array<output_t, blockSize> outputs;
+            voice->genNextBlock(outputs, timbreMod);
+            outputsEngine.insert(outputsEngine.end(), outputs.begin(), outputs.end());
+            reference->genNextBlock(outputsRefLeft.first(blockSize), timbreMod);
+            outputsRefLeft = outputsRefLeft.subspan(blockSize);
+        }
+    };
+    voice->gateStart();
+    reference->gateStart();
+    run(numHold);
+    voice->gateStop();
+    reference->gateStop();
+    run(numRelease);
+    return compare(outputsEngine, outputsRef);
+}
+
+static void usage()
+{
+    fputs("Usage: DexyCompare [-b bank.dexy] [-p patch] [-n note] [-t hold-seconds] [-r release-seconds]\n"
+          "                   [-m timbre]\n", stderr);
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    auto parseOption = [&options](char option, const char* value) {
+        unsigned n = 0;
+        switch (option) {
+        case 'b': options.bankFile = value; return true;
+        case 'p':
+            if (!parseUnsigned(value, &n) || n >= Patches::numPatches)
+                return false;
+            options.iPatch = int(n);
+            return true;
+        case 'n': return parseUnsigned(value, &options.note) && options.note <= 127;
+        case 't': return parseDouble(value, &options.holdTime) && options.holdTime >= 0 && options.holdTime <= 60;
+        case 'r': return parseDouble(value, &options.releaseTime) && options.releaseTime >= 0
+                         && options.releaseTime <= 60;
+        case 'm': return parseDouble(value, &options.timbre) && std::abs(options.timbre) <= 1;
+        default: return false;
+        }
+    };
+    if (!parseOptions(argc, argv, parseOption)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    Patches::init();
+    SineWave::init();
+    Envelope::init();
+    if (options.bankFile && !readPatchBank(options.bankFile)) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Note %u, %.2f s held, %.2f s released, timbre %.2f\n",
+           options.note, options.holdTime, options.releaseTime, options.timbre);
+    printf("%-2s  %-16s  %8s  %8s  %8s  %8s\n", "#", "patch", "SNR dB", "max err", "at s", "spect dB");
+    for (unsigned iPatch = 0; iPatch < Patches::numPatches; ++iPatch) {
+        if (options.iPatch >= 0 && unsigned(options.iPatch) != iPatch) {
+            continue;
+        }
+        const Patches::Patch& patch = Patches::getPatch(iPatch);
+        Comparison result = comparePatch(patch, options);
+        printf("%02u  %.*s  %8.1f  %8.0f  %8.3f  %8.2f\n", iPatch, int(patch.name.size()), patch.name.data(),
+               result.snrDb, result.maxError, result.maxErrorTime, result.spectrumDb);
+    }
+    return EXIT_SUCCESS;
+}
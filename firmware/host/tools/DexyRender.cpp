@@ -0,0 +1,351 @@
+// DexyRender - Offline renderer for Dexy patch banks
+//
+// Plays a script of note events through the synth engine for one patch or all
+// the patches in a bank, and writes a WAV file for each patch. Patches are
+// rendered concurrently by a pool of threads.
+//
+// Usage: DexyRender [options] events-file output-dir
+//   -b bank.dexy  Patch bank (default: the built-in default.dexy)
+//   -p n          Render only patch n (0-based)
+//   -r rate       Output sample rate in Hz (default: the engine's rate)
+//   -j threads    Number of threads (default: one per CPU)
+//   -v voices     Notes that can play at once (1 to maxVoices, default 1)
+//
+// Events file: one event per line, "time command [value]", with the time in
+// seconds and '#' starting a comment:
+//   0.0  on 57       start MIDI note 57 (fractions of a semitone are allowed)
+//   1.5  off 57      stop it
+//   2.0  timbre 0.5  set timbre modulation, -1 to 1
+//   4.0  end         stop rendering (default: 2 s after the last event)
+
+#include "ToolUtils.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace Dexy;
+using namespace Dexy::Synth;
+using namespace Dexy::ToolUtils;
+
+/// @brief Maximum number of voices (option -v)
+constexpr unsigned maxVoices = 16;
+
+/// @brief One event from the events file
+struct Event
+{
+    enum class Type : char { noteOn, noteOff, timbre, end };
+    uint64_t sample = 0;    ///< Time in samples at the engine's rate
+    Type type = Type::end;
+    double value = 0;
+};
+
+/// @brief Settings from the command line
+struct Options
+{
+    const char* bankFile = nullptr;
+    const char* eventsFile = nullptr;
+    const char* outputDir = nullptr;
+    int iPatch = -1;
+    unsigned sampleRate = SineWave::freqSample;
+    unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned numVoices = 1;
+};
+
+/// @brief Read the events file
+/// @param filename
+/// @param[out] events Events, sorted by time, ending with an end event
+/// @return Success
+static bool readEvents(const char* filename, std::vector<Event>* events)
+{
+    std::ifstream file(filename);
+    if (!file) {
+        fprintf(stderr, "Can't open %s\n", filename);
+        return false;
+    }
+    std::string line;
+    for (unsigned iLine = 1; std::getline(file, line); ++iLine) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        double time;
+        std::string command;
+        if (!(fields >> time)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+            fprintf(stderr, "%s:%u: Bad time\n", filename, iLine);
+            return false;
+        }
+        Event event;
+        event.sample = uint64_t(std::max(time, 0.0) * SineWave::freqSample + 0.5);
+        fields >> command;
+        if (command == "on" || command == "off" || command == "timbre") {
+            if (!(fields >> event.value)) {
+                fprintf(stderr, "%s:%u: %s needs a value\n", filename, iLine, command.c_str());
+                return false;
+            }
+            event.type = (command == "on") ? Event::Type::noteOn
+                : (command == "off") ? Event::Type::noteOff : Event::Type::timbre;
+        } else if (command == "end") {
+            event.type = Event::Type::end;
+        } else {
+            fprintf(stderr, "%s:%u: Unknown command \"%s\"\n", filename, iLine, command.c_str());
+            return false;
+        }
+        events->push_back(event);
+    }
+    std::ranges::stable_sort(*events, {}, &Event::sample);
+    if (events->empty() || events->back().type != Event::Type::end) {
+        uint64_t last = events->empty() ? 0 : events->back().sample;
+        events->push_back(Event{ .sample = last + 2 * SineWave::freqSample });
+    }
+    return true;
+}
+
+/// @brief WAV file writer for 16-bit mono samples, buffered
+class WavWriter
+{
+public:
+    /// @brief Open the file and write a header, to be completed by close()
+    bool open(const std::string& filename, unsigned sampleRate)
+    {
+        file = fopen(filename.c_str(), "wb");
+        if (!file)
+            return false;
+        setvbuf(file, nullptr, _IOFBF, 1 << 16);
+        writeHeader(sampleRate, 0);
+        return true;
+    }
+
+    /// @brief Write samples
+    void write(std::span<const output_t> samples)
+    {
+        // WAV files are little-endian, the same as the host
+        fwrite(samples.data(), sizeof(output_t), samples.size(), file);
+        numSamples += uint32_t(samples.size());
+    }
+
+    /// @brief Fill in the sizes in the header and close the file
+    /// @return Success
+    bool close(unsigned sampleRate)
+    {
+        fseek(file, 0, SEEK_SET);
+        writeHeader(sampleRate, numSamples);
+        bool fOk = !ferror(file);
+        return (fclose(file) == 0) && fOk;
+    }
+
+private:
+    void writeHeader(unsigned sampleRate, uint32_t samples)
+    {
+        uint32_t dataSize = samples * sizeof(output_t);
+        auto put32 = [this](uint32_t v) { fwrite(&v, 4, 1, file); };
+        auto put16 = [this](uint16_t v) { fwrite(&v, 2, 1, file); };
+        fwrite("RIFF", 4, 1, file);
+        put32(36 + dataSize);
+        fwrite("WAVEfmt ", 8, 1, file);
+        put32(16);                              // fmt chunk size
+        put16(1);                               // PCM
+        put16(1);                               // mono
+        put32(sampleRate);
+        put32(sampleRate * sizeof(output_t));   // bytes per second
+        put16(sizeof(output_t));                // bytes per frame
+        put16(16);                              // bits per sample
+        fwrite("data", 4, 1, file);
+        put32(dataSize);
+    }
+
+    FILE* file = nullptr;
+    uint32_t numSamples = 0;
+};
+
+/// @brief Linear-interpolation sample rate converter from the engine's rate
+/// @details Simple and not band-limited: fine for auditioning, but use the
+/// engine's own rate for anything that will be measured.
+class Resampler
+{
+public:
+    explicit Resampler(unsigned rateOut) : step(double(SineWave::freqSample) / rateOut) { }
+
+    /// @brief Convert a block of samples
+    /// @param in Samples at the engine's rate
+    /// @param[out] out Output samples are appended to this
+    void process(std::span<const output_t> in, std::vector<output_t>* out)
+    {
+        for (output_t sample : in) {
+            // pos is the position of the next output relative to prev (0)
+            // and sample (1)
+            while (pos <= 1.0) {
+                out->push_back(output_t(std::lround(prev + (sample - prev) * pos)));
+                pos += step;
+            }
+            pos -= 1.0;
+            prev = sample;
+        }
+    }
+
+private:
+    double step;
+    double pos = 1.0;
+    output_t prev = 0;
+};
+
+/// @brief Pitch of a note from the events file
+/// @param note MIDI note number, possibly with a fraction
+static phase_t pitchForNote(double note)
+{
+    return SineWave::getIncrementForMidiNoteFast(
+        midiNote_t(std::lround(std::clamp(note, -128.0, 127.99) * midiNoteSemitone)));
+}
+
+/// @brief Render one patch to a WAV file
+/// @tparam NUM_VOICES Number of notes that can play at once
+/// @return Success
+template<unsigned NUM_VOICES>
+static bool renderPatch(unsigned iPatch, const std::vector<Event>& events, const Options& options)
+{
+    const Patches::Patch& patch = Patches::getPatch(iPatch);
+    std::string name(toStringView(patch.name));
+    name.erase(name.find_last_not_of(' ') + 1);
+    for (char& c : name) {
+        if (!std::isalnum((unsigned char)c) && c != '-' && c != '_')
+            c = '_';
+    }
+    char prefix[8];
+    snprintf(prefix, sizeof(prefix), "%02u-", iPatch);
+    std::string filename = std::string(options.outputDir) + "/" + prefix + name + ".wav";
+
+    // Voices are big, so they don't go on the thread's stack
+    auto pool = std::make_unique<VoicePool<NUM_VOICES>>();
+    pool->setSettings(Voice::makeSettings(patch));
+
+    WavWriter wav;
+    if (!wav.open(filename, options.sampleRate)) {
+        fprintf(stderr, "Can't create %s\n", filename.c_str());
+        return false;
+    }
+    Resampler resampler(options.sampleRate);
+    const bool fResample = (options.sampleRate != SineWave::freqSample);
+    std::vector<output_t> resampled;
+    std::array<output_t, 1024> buf;
+    output_t timbreMod = 0;
+    uint64_t sample = 0;
+    for (const Event& event : events) {
+        // Render up to the event
+        while (sample < event.sample) {
+            std::size_t numSamples = std::size_t(std::min<uint64_t>(buf.size(), event.sample - sample));
+            std::span<output_t> block(buf.data(), numSamples);
+            pool->genNextBlock(block, timbreMod);
+            if (fResample) {
+                resampled.clear();
+                resampler.process(block, &resampled);
+                wav.write(resampled);
+            } else {
+                wav.write(block);
+            }
+            sample += numSamples;
+        }
+        switch (event.type) {
+        case Event::Type::noteOn:
+            pool->noteOn(pitchForNote(event.value));
+            break;
+        case Event::Type::noteOff:
+            pool->noteOff(pitchForNote(event.value));
+            break;
+        case Event::Type::timbre:
+            timbreMod = output_t(std::lround(std::clamp(event.value, -1.0, 1.0) * INT16_MAX));
+            break;
+        case Event::Type::end:
+            break;
+        }
+        if (event.type == Event::Type::end)
+            break;
+    }
+    if (!wav.close(options.sampleRate)) {
+        fprintf(stderr, "Error writing %s\n", filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/// @brief renderPatch() for each number of voices, 1 to maxVoices
+static constexpr auto renderPatchFuncs =
+    []<std::size_t... i>(std::index_sequence<i...>) {
+        return std::array{ &renderPatch<unsigned(i + 1)>... };
+    }(std::make_index_sequence<maxVoices>());
+
+static void usage()
+{
+    fputs("Usage: DexyRender [-b bank.dexy] [-p patch] [-r rate] [-j threads] [-v voices]\n"
+          "                  events-file output-dir\n", stderr);
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::vector<const char*> args;
+    auto parseOption = [&options](char option, const char* value) {
+        unsigned n = 0;
+        switch (option) {
+        case 'b': options.bankFile = value; return true;
+        case 'p':
+            if (!parseUnsigned(value, &n) || n >= Patches::numPatches)
+                return false;
+            options.iPatch = int(n);
+            return true;
+        case 'r': return parseUnsigned(value, &options.sampleRate) && options.sampleRate > 0;
+        case 'j': return parseUnsigned(value, &options.numThreads) && options.numThreads > 0;
+        case 'v': return parseUnsigned(value, &options.numVoices)
+                         && options.numVoices > 0 && options.numVoices <= maxVoices;
+        default: return false;
+        }
+    };
+    if (!parseOptions(argc, argv, parseOption, &args) || args.size() != 2) {
+        usage();
+        return EXIT_FAILURE;
+    }
+    options.eventsFile = args[0];
+    options.outputDir = args[1];
+
+    Patches::init();
+    SineWave::init();
+    Envelope::init();
+    if (options.bankFile && !readPatchBank(options.bankFile)) {
+        return EXIT_FAILURE;
+    }
+    std::vector<Event> events;
+    if (!readEvents(options.eventsFile, &events)) {
+        return EXIT_FAILURE;
+    }
+
+#ifdef WAVETABLE_HW_INTERP
+    // The interpolator model is shared, like the hardware on one core
+    options.numThreads = 1;
+#endif
+
+    // Patches are handed out to the threads one at a time
+    std::vector<unsigned> patchList;
+    if (options.iPatch >= 0) {
+        patchList.push_back(unsigned(options.iPatch));
+    } else {
+        for (unsigned i = 0; i < Patches::numPatches; ++i)
+            patchList.push_back(i);
+    }
+    std::atomic<unsigned> iNext = 0;
+    std::atomic<unsigned> numFailed = 0;
+    auto worker = [&]() {
+        for (unsigned i; (i = iNext++) < patchList.size(); ) {
+            if (!renderPatchFuncs[options.numVoices - 1](patchList[i], events, options))
+                ++numFailed;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < std::min<std::size_t>(options.numThreads, patchList.size()); ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    return (numFailed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,73 @@
+// ToolUtils - Helpers for the host tools
+
+#pragma once
+
+#include "DexyCore.h"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace Dexy { namespace ToolUtils {
+
+/// @brief Read a patch bank file into the current PatchBank
+/// @param filename
+/// @return Success
+inline bool readPatchBank(const char* filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file && !file.eof()) {
+        fprintf(stderr, "Can't read %s\n", filename);
+        return false;
+    }
+    if (!Patches::loadCurrentPatchBank(std::span<const char>(data))) {
+        fprintf(stderr, "%s is not a valid patch bank\n", filename);
+        return false;
+    }
+    return true;
+}
+
+/// @brief Parse an unsigned number option
+inline bool parseUnsigned(const char* str, unsigned* value)
+{
+    auto [end, ec] = std::from_chars(str, str + strlen(str), *value);
+    return ec == std::errc() && *end == '\0';
+}
+
+/// @brief Parse a number option
+inline bool parseDouble(const char* str, double* value)
+{
+    auto [end, ec] = std::from_chars(str, str + strlen(str), *value);
+    return ec == std::errc() && *end == '\0';
+}
+
+/// @brief Parse a command line of "-x value" options and other arguments
+/// @param argc, argv From main()
+/// @param parseOption Called as parseOption(char letter, const char* value)
+/// for each option; returns false if the option is unknown or the value is bad
+/// @param[out] args The other arguments, in order, or nullptr if there must be
+/// none
+/// @return Success (false after reporting what was wrong)
+inline bool parseOptions(int argc, char* argv[], auto parseOption, std::vector<const char*>* args = nullptr)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.size() == 2 && arg[0] == '-' && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (!parseOption(arg[1], value)) {
+                fprintf(stderr, "Bad option %s %s\n", argv[i - 1], value);
+                return false;
+            }
+        } else if (args) {
+            args->push_back(argv[i]);
+        } else {
+            fprintf(stderr, "Unexpected argument %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} } // namespace ToolUtils
@@ -35,9 +35,11 @@ int main()
 #include "WaveTable.cpp"
 #include "SineWave.cpp"
 #include "AdcInput.cpp"
+#include "AdcMap.cpp"
 #include "Envelope.cpp"
 #include "Operator.cpp"
 #include "SpiDac.cpp"
+#include "Voice.cpp"
 #include "Synth.cpp"
 #include "SerialIO.cpp"
 #include "Display.cpp"